@@ -1,3 +1,5 @@
+import { ItemType } from './enums/ItemType'
+
 export interface GameConfig {
     weapons: {
         pistol: WeaponConfig
@@ -42,4 +44,18 @@ export class ConfigManager {
         }
         return ConfigManager.config
     }
+
+    static getWeapon(type: ItemType): WeaponConfig {
+        const weapons = ConfigManager.getConfig().weapons
+        switch (type) {
+            case ItemType.ITEM_GUN_PISTOL:
+                return weapons.pistol
+            case ItemType.ITEM_GUN_RIFLE:
+                return weapons.rifle
+            case ItemType.ITEM_GUN_SHOTGUN:
+                return weapons.shotgun
+            default:
+                throw new Error(`No weapon config for item type ${type}`)
+        }
+    }
 }
@@ -14,6 +14,7 @@ export class GameClient {
     lastSendAngle: number = 0
 
     private lastAngleSentTime: number = 0
+    private lastFlushTime: number = 0
     private lastSendMouseDown: boolean = false
 
     private constructor(world: World, host: string, port: number) {
@@ -58,7 +59,13 @@ export class GameClient {
             this.sendInputAngle(myEntity.getRot(), true)
         }
 
-        this.socket.flush()
+        // batch per-frame input at the server tick rate; edge events like
+        // clicks and reloads flush on their own
+        const flushInterval = 1000 / this.world.interpolator.getTickrate()
+        if (now - this.lastFlushTime >= flushInterval) {
+            this.lastFlushTime = now
+            this.socket.flush()
+        }
     }
 
     private sendInputDirection(direction: number) {
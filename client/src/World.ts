@@ -3,6 +3,7 @@ import { Entity } from './graphics/Entity'
 import { ItemType } from './enums/ItemType'
 import { Interpolator } from './Interpolator'
 import { Renderer } from './Renderer'
+import { SnapshotHistory } from './protocol/SnapshotHistory'
 
 export type InventorySlotState = {
     type: ItemType
@@ -21,9 +22,11 @@ export type WorldEffect = {
 export class World {
     renderer: Renderer
     interpolator: Interpolator = new Interpolator(this)
+    snapshots: SnapshotHistory = new SnapshotHistory()
     entities: Map<number, Entity> = new Map()
     projectiles: Map<number, Bullet> = new Map()
-    pendingProjectileDestroys: Set<number> = new Set()
+    // fan id -> one bullet per pellet, null once it hit something
+    pelletFans: Map<number, (Bullet | null)[]> = new Map()
     lastKnownServerTick: number = 0
     // maybe we can rethink these two identifiers... maybe a controlled entity id, and a camera entity id?
     cameraEntityId: number = -1
@@ -68,16 +71,29 @@ export class World {
     }
 
     removeProjectile(id: number) {
+        // destroys only go to clients that were sent the spawn, so an
+        // unknown id already expired here
         const projectile = this.projectiles.get(id)
-        if (!projectile) {
-            this.pendingProjectileDestroys.add(id)
-            return
-        }
+        if (!projectile) return
 
         projectile.destroy()
         this.projectiles.delete(id)
     }
 
+    addPelletFan(id: number, pellets: (Bullet | null)[]) {
+        this.pelletFans.get(id)?.forEach((bullet) => bullet?.destroy())
+        this.pelletFans.set(id, pellets)
+    }
+
+    removePellet(id: number, pellet: number) {
+        const pellets = this.pelletFans.get(id)
+        const bullet = pellets?.[pellet]
+        if (!pellets || !bullet) return
+
+        bullet.destroy()
+        pellets[pellet] = null
+    }
+
     update(delta: number, tick: number, now: number) {
         this.interpolator.update(delta, tick, now)
 
@@ -85,8 +101,27 @@ export class World {
             entity.update(delta, tick, now)
         })
 
-        this.projectiles.forEach((projectile) => {
+        this.projectiles.forEach((projectile, id) => {
             projectile.update(delta, tick, now)
+            if (projectile.isExpired()) {
+                projectile.destroy()
+                this.projectiles.delete(id)
+            }
+        })
+
+        this.pelletFans.forEach((pellets, id) => {
+            let flying = false
+            pellets.forEach((bullet, pellet) => {
+                if (!bullet) return
+                bullet.update(delta, tick, now)
+                if (bullet.isExpired()) {
+                    bullet.destroy()
+                    pellets[pellet] = null
+                } else {
+                    flying = true
+                }
+            })
+            if (!flying) this.pelletFans.delete(id)
         })
 
         this.effects.forEach((effect) => effect.update(delta, tick, now))
@@ -23,6 +23,8 @@ export class Bullet extends Entity {
     private velocityX: number = 0
     private velocityY: number = 0
     private motionAngle: number = 0
+    // seconds until the server would expire it, it is not told about it
+    private remainingLife: number = Infinity
 
     constructor(client: GameClient) {
         super()
@@ -60,6 +62,7 @@ export class Bullet extends Entity {
     }
 
     update(delta: number, _tick: number, _now: number) {
+        this.remainingLife -= delta
         this.position.x += this.velocityX * delta
         this.position.y += this.velocityY * delta
 
@@ -136,6 +139,14 @@ export class Bullet extends Entity {
         }
     }
 
+    setLifetime(seconds: number) {
+        this.remainingLife = seconds
+    }
+
+    isExpired(): boolean {
+        return this.remainingLife <= 0
+    }
+
     getRot(): number {
         return this.motionAngle
     }
@@ -0,0 +1,65 @@
+// Mirrors server/include/packet/buffer/BitReader.hpp, least significant bit
+// first.
+export class BitReader {
+    private bytes: Uint8Array = new Uint8Array(0)
+    private bitOffset: number = 0
+
+    // start reading at byteOffset, e.g. after a PacketReader header
+    loadBuffer(buffer: ArrayBuffer, byteOffset: number = 0) {
+        this.bytes = new Uint8Array(buffer)
+        this.bitOffset = byteOffset * 8
+    }
+
+    readBits(bits: number): number {
+        if (this.bitOffset + bits > this.bytes.length * 8) {
+            throw new Error(
+                `BitReader overflow: bitOffset=${this.bitOffset}, bits=${bits}`
+            )
+        }
+
+        let value = 0
+        let read = 0
+        while (read < bits) {
+            const shift = this.bitOffset & 7
+            const take = Math.min(8 - shift, bits - read)
+            const byte = this.bytes[this.bitOffset >>> 3] >>> shift
+
+            value |= (byte & ((1 << take) - 1)) << read
+            read += take
+            this.bitOffset += take
+        }
+        return value >>> 0
+    }
+
+    readBool(): boolean {
+        return this.readBits(1) !== 0
+    }
+
+    readVarU32(): number {
+        let value = 0
+        for (let shift = 0; shift < 35; shift += 7) {
+            const group = this.readBits(8)
+            value |= (group & 0x7f) << shift
+            if ((group & 0x80) === 0) return value >>> 0
+        }
+        throw new Error('BitReader varint too long')
+    }
+
+    readVarS32(): number {
+        const zigzag = this.readVarU32()
+        return (zigzag >>> 1) ^ -(zigzag & 1)
+    }
+
+    alignToByte() {
+        this.bitOffset = (this.bitOffset + 7) & ~7
+    }
+
+    // byte offset, rounded up when mid-byte
+    getOffset() {
+        return (this.bitOffset + 7) >>> 3
+    }
+
+    byteLength() {
+        return this.bytes.length
+    }
+}
@@ -2,11 +2,14 @@ interface IPacketReader {
     loadBuffer(buffer: ArrayBuffer): void
     readU8(): number
     readU16(): number
+    readI16(): number
     readU32(): number
     readU64(): number
     readFloat(): number
     readString(): string
     getOffset(): number
+    setOffset(offset: number): void
+    getBuffer(): ArrayBuffer
     byteLength(): number
 }
 
@@ -34,6 +37,12 @@ export class PacketReader implements IPacketReader {
         return value
     }
 
+    readI16(): number {
+        const value = this.view.getInt16(this.offset, true)
+        this.offset += 2
+        return value
+    }
+
     readU32(): number {
         const value = this.view.getUint32(this.offset, true)
         this.offset += 4
@@ -66,6 +75,15 @@ export class PacketReader implements IPacketReader {
         return this.offset
     }
 
+    // used to skip past a section decoded by another reader
+    setOffset(offset: number) {
+        this.offset = offset
+    }
+
+    getBuffer() {
+        return this.buffer
+    }
+
     byteLength() {
         return this.buffer.byteLength
     }
@@ -1,6 +1,7 @@
 interface IPacketWriter {
     writeU8(value: number): void
     writeU16(value: number): void
+    writeI16(value: number): void
     writeU32(value: number): void
     writeU64(value: number): void
     writeFloat(value: number): void
@@ -30,6 +31,11 @@ export class PacketWriter implements IPacketWriter {
         this.offset += 2
     }
 
+    writeI16(value: number) {
+        this.view.setInt16(this.offset, value, true)
+        this.offset += 2
+    }
+
     writeU32(value: number) {
         this.view.setUint32(this.offset, value, true)
         this.offset += 4
@@ -1,3 +1,6 @@
+// Generated by scripts/generate-protocol.js from protocol/schema.json.
+// Do not edit by hand.
+
 export const enum ClientHeader {
     SPAWN,
     MOUSE,
@@ -8,6 +11,7 @@ export const enum ClientHeader {
     RELOAD,
     SWITCH_ITEM,
     PICKUP_REQUEST,
+    SNAPSHOT_ACK,
 }
 
 export const enum ServerHeader {
@@ -32,4 +36,5 @@ export const enum ServerHeader {
     PROJECTILE_SPAWN_BATCH,
     PROJECTILE_DESTROY,
     GAME_CONFIG,
+    PROTOCOL,
 }
@@ -1,3 +1,6 @@
+export * from './buffer/BitReader'
 export * from './buffer/PacketReader'
 export * from './buffer/PacketWriter'
 export * from './header'
+export * from './protocol'
+export * from './quantize'
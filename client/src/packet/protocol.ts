@@ -0,0 +1,304 @@
+// Generated by scripts/generate-protocol.js from protocol/schema.json.
+// Do not edit by hand.
+
+import { PacketReader } from './buffer/PacketReader'
+import { PacketWriter } from './buffer/PacketWriter'
+
+export const PROTOCOL_VERSION = 7
+export const POSITION_SCALE = 4
+export const NULL_NET_ID = 65535
+export const SNAPSHOT_REMOVED = 0
+export const SNAPSHOT_CHANGED = 1
+export const SNAPSHOT_FULL = 2
+export const FAN_MAX_PELLETS = 16
+
+// Camera centre in pixels, sent before ENTITY_CREATE and PROJECTILE_SPAWN_BATCH
+// entries
+export interface SnapshotOrigin {
+    x: number
+    y: number
+}
+
+export const SNAPSHOT_ORIGIN_SIZE = 8
+
+export function readSnapshotOrigin(reader: PacketReader): SnapshotOrigin {
+    return {
+        x: reader.readFloat(),
+        y: reader.readFloat(),
+    }
+}
+
+export function writeSnapshotOrigin(
+    writer: PacketWriter,
+    record: SnapshotOrigin
+): void {
+    writer.writeFloat(record.x)
+    writer.writeFloat(record.y)
+}
+
+// ENTITY_CREATE entry, followed by PickupInfo for pickups
+export interface EntityCreate {
+    id: number
+    type: number
+    variant: number
+    x: number
+    y: number
+    angle: number
+}
+
+export const ENTITY_CREATE_SIZE = 10
+
+export function readEntityCreate(reader: PacketReader): EntityCreate {
+    return {
+        id: reader.readU16(),
+        type: reader.readU8(),
+        variant: reader.readU8(),
+        x: reader.readI16(),
+        y: reader.readI16(),
+        angle: reader.readU16(),
+    }
+}
+
+export function writeEntityCreate(
+    writer: PacketWriter,
+    record: EntityCreate
+): void {
+    writer.writeU16(record.id)
+    writer.writeU8(record.type)
+    writer.writeU8(record.variant)
+    writer.writeI16(record.x)
+    writer.writeI16(record.y)
+    writer.writeU16(record.angle)
+}
+
+// Trailing ENTITY_CREATE data for gun and ammo pickups
+export interface PickupInfo {
+    itemType: number
+    ammoType: number
+    amount: number
+}
+
+export const PICKUP_INFO_SIZE = 4
+
+export function readPickupInfo(reader: PacketReader): PickupInfo {
+    return {
+        itemType: reader.readU8(),
+        ammoType: reader.readU8(),
+        amount: reader.readU16(),
+    }
+}
+
+export function writePickupInfo(
+    writer: PacketWriter,
+    record: PickupInfo
+): void {
+    writer.writeU8(record.itemType)
+    writer.writeU8(record.ammoType)
+    writer.writeU16(record.amount)
+}
+
+// ENTITY_STATE body
+export interface EntityState {
+    id: number
+    state: number
+}
+
+export const ENTITY_STATE_SIZE = 3
+
+export function readEntityState(reader: PacketReader): EntityState {
+    return {
+        id: reader.readU16(),
+        state: reader.readU8(),
+    }
+}
+
+export function writeEntityState(
+    writer: PacketWriter,
+    record: EntityState
+): void {
+    writer.writeU16(record.id)
+    writer.writeU8(record.state)
+}
+
+// AMMO_UPDATE body
+export interface AmmoUpdate {
+    ammoInMag: number
+    ammoReserve: number
+    reloadRemaining: number
+}
+
+export const AMMO_UPDATE_SIZE = 8
+
+export function readAmmoUpdate(reader: PacketReader): AmmoUpdate {
+    return {
+        ammoInMag: reader.readU16(),
+        ammoReserve: reader.readU16(),
+        reloadRemaining: reader.readFloat(),
+    }
+}
+
+export function writeAmmoUpdate(
+    writer: PacketWriter,
+    record: AmmoUpdate
+): void {
+    writer.writeU16(record.ammoInMag)
+    writer.writeU16(record.ammoReserve)
+    writer.writeFloat(record.reloadRemaining)
+}
+
+// BULLET_TRACE body
+export interface BulletTrace {
+    shooter: number
+    startX: number
+    startY: number
+    endX: number
+    endY: number
+}
+
+export const BULLET_TRACE_SIZE = 18
+
+export function readBulletTrace(reader: PacketReader): BulletTrace {
+    return {
+        shooter: reader.readU16(),
+        startX: reader.readFloat(),
+        startY: reader.readFloat(),
+        endX: reader.readFloat(),
+        endY: reader.readFloat(),
+    }
+}
+
+export function writeBulletTrace(
+    writer: PacketWriter,
+    record: BulletTrace
+): void {
+    writer.writeU16(record.shooter)
+    writer.writeFloat(record.startX)
+    writer.writeFloat(record.startY)
+    writer.writeFloat(record.endX)
+    writer.writeFloat(record.endY)
+}
+
+// PROJECTILE_SPAWN_BATCH entry. x/y is the muzzle relative to the batch origin,
+// speed is the weapon's projectileSpeed from GAME_CONFIG and the projectile was
+// fired tickOffset ticks before the batch tick
+export interface ProjectileSpawn {
+    id: number
+    weapon: number
+    x: number
+    y: number
+    angle: number
+    tickOffset: number
+}
+
+export const PROJECTILE_SPAWN_SIZE = 10
+
+export function readProjectileSpawn(reader: PacketReader): ProjectileSpawn {
+    return {
+        id: reader.readU16(),
+        weapon: reader.readU8(),
+        x: reader.readI16(),
+        y: reader.readI16(),
+        angle: reader.readU16(),
+        tickOffset: reader.readU8(),
+    }
+}
+
+export function writeProjectileSpawn(
+    writer: PacketWriter,
+    record: ProjectileSpawn
+): void {
+    writer.writeU16(record.id)
+    writer.writeU8(record.weapon)
+    writer.writeI16(record.x)
+    writer.writeI16(record.y)
+    writer.writeU16(record.angle)
+    writer.writeU8(record.tickOffset)
+}
+
+// PROJECTILE_SPAWN_BATCH fan entry, one per multi-pellet shot. Pellet i flies
+// at angle + pelletSpread(seed, i), alive has a bit per pellet still in flight
+export interface FanSpawn {
+    id: number
+    weapon: number
+    x: number
+    y: number
+    angle: number
+    tickOffset: number
+    seed: number
+    alive: number
+}
+
+export const FAN_SPAWN_SIZE = 14
+
+export function readFanSpawn(reader: PacketReader): FanSpawn {
+    return {
+        id: reader.readU16(),
+        weapon: reader.readU8(),
+        x: reader.readI16(),
+        y: reader.readI16(),
+        angle: reader.readU16(),
+        tickOffset: reader.readU8(),
+        seed: reader.readU16(),
+        alive: reader.readU16(),
+    }
+}
+
+export function writeFanSpawn(
+    writer: PacketWriter,
+    record: FanSpawn
+): void {
+    writer.writeU16(record.id)
+    writer.writeU8(record.weapon)
+    writer.writeI16(record.x)
+    writer.writeI16(record.y)
+    writer.writeU16(record.angle)
+    writer.writeU8(record.tickOffset)
+    writer.writeU16(record.seed)
+    writer.writeU16(record.alive)
+}
+
+// PROJECTILE_DESTROY entry for one pellet of a fan
+export interface PelletImpact {
+    id: number
+    pellet: number
+}
+
+export const PELLET_IMPACT_SIZE = 3
+
+export function readPelletImpact(reader: PacketReader): PelletImpact {
+    return {
+        id: reader.readU16(),
+        pellet: reader.readU8(),
+    }
+}
+
+export function writePelletImpact(
+    writer: PacketWriter,
+    record: PelletImpact
+): void {
+    writer.writeU16(record.id)
+    writer.writeU8(record.pellet)
+}
+
+// NEWS body when the news type is KILL
+export interface KillNews {
+    subject: number
+    killer: number
+}
+
+export const KILL_NEWS_SIZE = 4
+
+export function readKillNews(reader: PacketReader): KillNews {
+    return {
+        subject: reader.readU16(),
+        killer: reader.readU16(),
+    }
+}
+
+export function writeKillNews(
+    writer: PacketWriter,
+    record: KillNews
+): void {
+    writer.writeU16(record.subject)
+    writer.writeU16(record.killer)
+}
@@ -0,0 +1,18 @@
+import { POSITION_SCALE } from './protocol'
+
+const ANGLE_STEPS = 65536
+
+// Inverse of quantizeOffset in server/include/packet/Quantize.hpp
+export function dequantizeOffset(origin: number, offset: number): number {
+    return origin + offset / POSITION_SCALE
+}
+
+// Inverse of quantizePosition, absolute positions in the delta snapshots
+export function dequantizePosition(position: number): number {
+    return position / POSITION_SCALE
+}
+
+// Inverse of quantizeAngle, returns radians in [0, 2pi)
+export function dequantizeAngle(angle: number): number {
+    return (angle / ANGLE_STEPS) * Math.PI * 2
+}
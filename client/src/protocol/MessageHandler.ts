@@ -1,4 +1,25 @@
-import { PacketReader, ServerHeader } from '../packet'
+import {
+    BitReader,
+    ClientHeader,
+    FAN_MAX_PELLETS,
+    NULL_NET_ID,
+    PROTOCOL_VERSION,
+    PacketReader,
+    ServerHeader,
+    dequantizeAngle,
+    dequantizeOffset,
+    dequantizePosition,
+    readAmmoUpdate,
+    readBulletTrace,
+    readEntityCreate,
+    readEntityState,
+    readFanSpawn,
+    readKillNews,
+    readPelletImpact,
+    readPickupInfo,
+    readProjectileSpawn,
+    readSnapshotOrigin,
+} from '../packet'
 import { GameClient } from '../GameClient'
 import { Nicknames, Player } from '../graphics/Player'
 import { assert } from '../utils/assert'
@@ -14,12 +35,22 @@ import { Bullet } from '../graphics/Bullet'
 import { HitscanTracer } from '../graphics/HitscanTracer'
 import { ItemType } from '../enums/ItemType'
 import { ConfigManager, GameConfig } from '../ConfigManager'
+import { PIXELS_PER_METER } from '../utils/constants'
+import { pelletSpread } from '../utils/spread'
 
 export class MessageHandler {
     static handle(reader: PacketReader, client: GameClient): void {
         const messageType = reader.readU8()
 
         switch (messageType) {
+            case ServerHeader.PROTOCOL: {
+                const version = reader.readU16()
+                assert(
+                    version === PROTOCOL_VERSION,
+                    `Protocol mismatch: server ${version}, client ${PROTOCOL_VERSION}`
+                )
+                break
+            }
             case ServerHeader.MAP_INIT: {
                 const size = reader.readU32()
                 console.log('Map initialized with size: ', size)
@@ -33,28 +64,29 @@ export class MessageHandler {
             }
             case ServerHeader.SPAWN_SUCCESS: {
                 console.log('Spawn success')
-                const entity = reader.readU32()
+                const entity = reader.readU16()
                 client.world.cameraEntityId = entity
                 client.world.active = true
                 break
             }
             case ServerHeader.SET_CAMERA: {
                 console.log('Set camera')
-                const targetEntity = reader.readU32()
-                client.world.cameraEntityId = targetEntity
+                const targetEntity = reader.readU16()
+                client.world.cameraEntityId =
+                    targetEntity === NULL_NET_ID ? -1 : targetEntity
                 break
             }
             case ServerHeader.ENTITY_CREATE: {
                 console.log('Entity create')
+                const origin = readSnapshotOrigin(reader)
                 const count = reader.readU32()
 
                 for (let i = 0; i < count; i++) {
-                    const id = reader.readU32()
-                    const type = reader.readU8()
-                    const variant = reader.readU8()
-                    const x = reader.readFloat()
-                    const y = reader.readFloat()
-                    const angle = reader.readFloat()
+                    const record = readEntityCreate(reader)
+                    const { id, type, variant } = record
+                    const x = dequantizeOffset(origin.x, record.x)
+                    const y = dequantizeOffset(origin.y, record.y)
+                    const angle = dequantizeAngle(record.angle)
 
                     let pickupItemType = ItemType.ITEM_NONE
                     let pickupAmmoType = 0
@@ -64,9 +96,10 @@ export class MessageHandler {
                         type === EntityTypes.GUN_PICKUP ||
                         type === EntityTypes.AMMO_PICKUP
                     ) {
-                        pickupItemType = reader.readU8() as ItemType
-                        pickupAmmoType = reader.readU8()
-                        pickupAmount = reader.readU16()
+                        const pickup = readPickupInfo(reader)
+                        pickupItemType = pickup.itemType as ItemType
+                        pickupAmmoType = pickup.ammoType
+                        pickupAmount = pickup.amount
                     }
 
                     let entity: Entity
@@ -159,13 +192,34 @@ export class MessageHandler {
                 break
             }
             case ServerHeader.ENTITY_UPDATE: {
-                const count = reader.readU32()
-
-                for (let i = 0; i < count; i++) {
-                    const id = reader.readU32()
-                    const x = reader.readFloat()
-                    const y = reader.readFloat()
-                    const angle = reader.readFloat()
+                const tick = reader.readU32()
+                const baselineTick = reader.readU32()
+                const count = reader.readU16()
+
+                const bits = new BitReader()
+                bits.loadBuffer(reader.getBuffer(), reader.getOffset())
+                const snapshot = client.world.snapshots.read(
+                    bits,
+                    tick,
+                    baselineTick,
+                    count
+                )
+                reader.setOffset(bits.getOffset())
+
+                // The server only deltas against ticks we acked, so this
+                // means we fell far behind. Not acking lets it fall back to a
+                // keyframe once the baseline leaves its history.
+                if (!snapshot) break
+
+                client.socket.streamWriter.writeU8(ClientHeader.SNAPSHOT_ACK)
+                client.socket.streamWriter.writeU32(tick)
+
+                // unchanged entities are left out of the message but still
+                // get a sample, so interpolation keeps a steady timeline
+                for (const [id, state] of snapshot) {
+                    const x = dequantizePosition(state.x)
+                    const y = dequantizePosition(state.y)
+                    const angle = dequantizeAngle(state.angle)
                     const entity = client.world.entities.get(id)!
 
                     assert(
@@ -188,7 +242,7 @@ export class MessageHandler {
                 const count = reader.readU32()
 
                 for (let i = 0; i < count; i++) {
-                    const id = reader.readU32()
+                    const id = reader.readU16()
                     const entity = client.world.entities.get(id)!
                     assert(
                         entity != undefined,
@@ -202,8 +256,7 @@ export class MessageHandler {
             }
             case ServerHeader.ENTITY_STATE: {
                 console.log('Entity state')
-                const id = reader.readU32()
-                const state = reader.readU8()
+                const { id, state } = readEntityState(reader)
                 const entity = client.world.entities.get(id)!
                 assert(entity != undefined, `Entity with ID: ${id} not found`)
 
@@ -265,9 +318,8 @@ export class MessageHandler {
                 break
             }
             case ServerHeader.AMMO_UPDATE: {
-                const ammoInMag = reader.readU16()
-                const ammoReserve = reader.readU16()
-                const reloadRemaining = reader.readFloat()
+                const { ammoInMag, ammoReserve, reloadRemaining } =
+                    readAmmoUpdate(reader)
 
                 client.world.activeAmmoInMag = ammoInMag
                 client.world.activeAmmoReserve = ammoReserve
@@ -275,11 +327,8 @@ export class MessageHandler {
                 break
             }
             case ServerHeader.BULLET_TRACE: {
-                const shooter = reader.readU32() // prob can get rid of this
-                const startX = reader.readFloat()
-                const startY = reader.readFloat()
-                const endX = reader.readFloat()
-                const endY = reader.readFloat()
+                // shooter is unused, prob can get rid of it
+                const { startX, startY, endX, endY } = readBulletTrace(reader)
 
                 const tracer = new HitscanTracer(startX, startY, endX, endY)
                 client.world.renderer.foreground.addChild(tracer)
@@ -290,31 +339,35 @@ export class MessageHandler {
                 const serverTick = reader.readU64()
                 client.world.lastKnownServerTick = serverTick
 
+                const origin = readSnapshotOrigin(reader)
                 const count = reader.readU32()
                 const tickRate = client.world.interpolator.getTickrate()
                 const maxCatchupTicks = 200
 
                 for (let i = 0; i < count; i++) {
-                    const id = reader.readU32()
-                    const originX = reader.readFloat()
-                    const originY = reader.readFloat()
-                    const dirX = reader.readFloat()
-                    const dirY = reader.readFloat()
-                    const speed = reader.readFloat()
-                    const spawnTick = reader.readU64()
-
-                    if (client.world.pendingProjectileDestroys.has(id)) {
-                        client.world.pendingProjectileDestroys.delete(id)
-                        continue
-                    }
-
-                    const elapsedTicks = Math.max(0, serverTick - spawnTick)
+                    const record = readProjectileSpawn(reader)
+                    const id = record.id
+                    const originX = dequantizeOffset(origin.x, record.x)
+                    const originY = dequantizeOffset(origin.y, record.y)
+                    const angle = dequantizeAngle(record.angle)
+                    const dirX = Math.cos(angle)
+                    const dirY = Math.sin(angle)
+                    const weapon = ConfigManager.getWeapon(record.weapon)
+                    const speed = weapon.projectileSpeed * PIXELS_PER_METER
+
+                    const elapsedTicks = record.tickOffset
 
                     if (elapsedTicks > maxCatchupTicks) {
                         continue
                     }
 
                     const elapsedTime = elapsedTicks / tickRate
+                    const remainingLife =
+                        weapon.projectileLifetime - elapsedTime
+                    if (remainingLife <= 0) {
+                        continue
+                    }
+
                     const posX = originX + dirX * speed * elapsedTime
                     const posY = originY + dirY * speed * elapsedTime
 
@@ -329,13 +382,69 @@ export class MessageHandler {
                     bullet._type = EntityTypes.BULLET
                     bullet.position.set(posX, posY)
                     bullet.setMotion(dirX, dirY, speed)
+                    bullet.setLifetime(remainingLife)
                     client.world.addProjectile(bullet)
                 }
+
+                // multi-pellet shots, every pellet direction comes from the
+                // fan's seed
+                const fanCount = reader.readU16()
+                for (let i = 0; i < fanCount; i++) {
+                    const record = readFanSpawn(reader)
+                    const originX = dequantizeOffset(origin.x, record.x)
+                    const originY = dequantizeOffset(origin.y, record.y)
+                    const angle = dequantizeAngle(record.angle)
+                    const weapon = ConfigManager.getWeapon(record.weapon)
+                    const speed = weapon.projectileSpeed * PIXELS_PER_METER
+
+                    const elapsedTime = record.tickOffset / tickRate
+                    const remainingLife =
+                        weapon.projectileLifetime - elapsedTime
+                    if (remainingLife <= 0) {
+                        continue
+                    }
+
+                    const pellets: (Bullet | null)[] = []
+                    for (let pellet = 0; pellet < FAN_MAX_PELLETS; pellet++) {
+                        if (!(record.alive & (1 << pellet))) {
+                            pellets.push(null)
+                            continue
+                        }
+
+                        const pelletAngle =
+                            angle +
+                            pelletSpread(record.seed, pellet, weapon.spread)
+                        const dirX = Math.cos(pelletAngle)
+                        const dirY = Math.sin(pelletAngle)
+
+                        const bullet = new Bullet(client)
+                        bullet._id = record.id
+                        bullet._type = EntityTypes.BULLET
+                        bullet.position.set(
+                            originX + dirX * speed * elapsedTime,
+                            originY + dirY * speed * elapsedTime
+                        )
+                        bullet.setMotion(dirX, dirY, speed)
+                        bullet.setLifetime(remainingLife)
+                        pellets.push(bullet)
+                    }
+                    client.world.addPelletFan(record.id, pellets)
+                }
                 break
             }
             case ServerHeader.PROJECTILE_DESTROY: {
-                const id = reader.readU32()
-                client.world.removeProjectile(id)
+                // impacts only, projectiles that run out of lifetime are
+                // expired locally
+                const count = reader.readU16()
+                for (let i = 0; i < count; i++) {
+                    client.world.removeProjectile(reader.readU16())
+                }
+
+                const pelletCount = reader.readU16()
+                for (let i = 0; i < pelletCount; i++) {
+                    const { id, pellet } = readPelletImpact(reader)
+                    client.world.removePellet(id, pellet)
+                }
                 break
             }
             case ServerHeader.HEALTH: {
@@ -359,7 +468,7 @@ export class MessageHandler {
             }
             case ServerHeader.PLAYER_JOIN: {
                 console.log('Player join')
-                const id = reader.readU32()
+                const id = reader.readU16()
                 const name = reader.readString()
 
                 Nicknames.set(id, name)
@@ -367,7 +476,7 @@ export class MessageHandler {
             }
             case ServerHeader.PLAYER_LEAVE: {
                 console.log('Player leave')
-                const id = reader.readU32()
+                const id = reader.readU16()
 
                 Nicknames.delete(id)
                 break
@@ -390,8 +499,7 @@ export class MessageHandler {
                         break
                     }
                     case NewsType.KILL: {
-                        const subject = reader.readU32()
-                        const killer = reader.readU32()
+                        const { subject, killer } = readKillNews(reader)
 
                         assert(
                             Nicknames.has(subject),
@@ -418,7 +526,7 @@ export class MessageHandler {
             }
             case ServerHeader.SERVER_CHAT: {
                 console.log('Received a chat message!')
-                const id = reader.readU32()
+                const id = reader.readU16()
                 const message = reader.readString()
 
                 assert(
@@ -0,0 +1,82 @@
+import {
+    BitReader,
+    SNAPSHOT_CHANGED,
+    SNAPSHOT_FULL,
+    SNAPSHOT_REMOVED,
+} from '../packet'
+
+// quantized transform, see EntitySnapshot in
+// server/include/client/SnapshotHistory.hpp
+export type EntitySnapshot = {
+    x: number
+    y: number
+    angle: number
+}
+
+export type Snapshot = Map<number, EntitySnapshot>
+
+// twice the server's history, so any baseline it picks is still here
+const SIZE = 64
+
+const EMPTY: Snapshot = new Map()
+
+// Rebuilds ENTITY_UPDATE snapshots from the delta entries the server sends
+// against a snapshot we acked earlier.
+export class SnapshotHistory {
+    private ticks: number[] = new Array(SIZE).fill(0)
+    private snapshots: Snapshot[] = new Array(SIZE).fill(EMPTY)
+
+    find(tick: number): Snapshot | undefined {
+        if (tick === 0) return EMPTY
+        const slot = tick % SIZE
+        return this.ticks[slot] === tick ? this.snapshots[slot] : undefined
+    }
+
+    // Apply `count` entries on top of the baseline and store the result.
+    // Returns undefined if the baseline is gone, the entries are still read
+    // so the caller can skip past them.
+    read(
+        reader: BitReader,
+        tick: number,
+        baselineTick: number,
+        count: number
+    ): Snapshot | undefined {
+        const baseline = this.find(baselineTick)
+        const snapshot: Snapshot = new Map(baseline ?? EMPTY)
+
+        let id = 0
+        for (let i = 0; i < count; i++) {
+            id += reader.readVarU32()
+
+            switch (reader.readBits(2)) {
+                case SNAPSHOT_REMOVED:
+                    snapshot.delete(id)
+                    break
+                case SNAPSHOT_CHANGED: {
+                    const entity = { ...snapshot.get(id)! }
+                    if (reader.readBool()) {
+                        entity.x += reader.readVarS32()
+                        entity.y += reader.readVarS32()
+                    }
+                    if (reader.readBool()) entity.angle = reader.readBits(16)
+                    snapshot.set(id, entity)
+                    break
+                }
+                case SNAPSHOT_FULL:
+                    snapshot.set(id, {
+                        x: reader.readVarS32(),
+                        y: reader.readVarS32(),
+                        angle: reader.readBits(16),
+                    })
+                    break
+            }
+        }
+
+        if (!baseline) return undefined
+
+        const slot = tick % SIZE
+        this.ticks[slot] = tick
+        this.snapshots[slot] = snapshot
+        return snapshot
+    }
+}
@@ -3,3 +3,6 @@ export const COLORS = {
 }
 
 export const STROKE_WIDTH = 6
+
+// server/src/util/units.cpp, config values are in meters
+export const PIXELS_PER_METER = 100
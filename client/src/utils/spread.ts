@@ -0,0 +1,21 @@
+// Mirrors server/include/util/spread.hpp. The hash is integer math and the
+// result is rounded to float like the server's, so both get the same offset
+// for a seed; the angle it is added to is still a double here.
+export function pelletSpread(
+    seed: number,
+    pellet: number,
+    spread: number
+): number {
+    let x =
+        (Math.imul(seed, 0x9e3779b1) + Math.imul(pellet + 1, 0x85ebca77)) >>> 0
+    x ^= x >>> 16
+    x = Math.imul(x, 0x85ebca6b) >>> 0
+    x ^= x >>> 13
+    x = Math.imul(x, 0xc2b2ae35) >>> 0
+    x ^= x >>> 16
+
+    const random01 = (x >>> 8) / 16777216
+    // spread is a float on the server, the product of two floats is exact in
+    // a double so one fround gives the float multiply's result
+    return Math.fround((random01 * 2 - 1) * Math.fround(spread))
+}
@@ -0,0 +1,217 @@
+// Generates the packet headers and fixed-layout record codecs for the server
+// and the client from protocol/schema.json.
+//
+//   node scripts/generate-protocol.js
+//
+// Outputs are committed; re-run this after editing the schema.
+const fs = require('fs')
+const path = require('path')
+
+const root = path.resolve(__dirname, '..')
+const schema = JSON.parse(
+    fs.readFileSync(path.join(root, 'protocol/schema.json'), 'utf8')
+)
+
+const CPP_OUT = path.join(root, 'server/include/packet/Protocol.hpp')
+const TS_HEADER_OUT = path.join(root, 'client/src/packet/header.ts')
+const TS_RECORDS_OUT = path.join(root, 'client/src/packet/protocol.ts')
+
+const TYPES = {
+    u8: { size: 1, cpp: 'uint8_t', ts: 'U8' },
+    u16: { size: 2, cpp: 'uint16_t', ts: 'U16' },
+    i16: { size: 2, cpp: 'int16_t', ts: 'I16' },
+    u32: { size: 4, cpp: 'uint32_t', ts: 'U32' },
+    u64: { size: 8, cpp: 'uint64_t', ts: 'U64' },
+    f32: { size: 4, cpp: 'float', ts: 'Float' },
+}
+
+const BANNER = [
+    '// Generated by scripts/generate-protocol.js from protocol/schema.json.',
+    '// Do not edit by hand.',
+].join('\n')
+
+function recordSize(record) {
+    return record.fields.reduce((size, [name, type]) => {
+        if (!TYPES[type]) {
+            throw new Error(`${record.name}.${name}: unknown type ${type}`)
+        }
+        return size + TYPES[type].size
+    }, 0)
+}
+
+// EntityUpdate -> ENTITY_UPDATE
+function constantName(name) {
+    return name.replace(/([a-z0-9])([A-Z])/g, '$1_$2').toUpperCase()
+}
+
+function cppEnum(name, values) {
+    const lines = [`enum ${name} : uint8_t {`]
+    for (const value of values) lines.push(`    ${value},`)
+    lines.push('};')
+    return lines.join('\n')
+}
+
+// Wrap a doc string into // comment lines that fit in 80 columns
+function comment(text) {
+    const lines = []
+    let line = '//'
+    for (const word of text.split(' ')) {
+        if (line.length + word.length + 1 > 80) {
+            lines.push(line)
+            line = '//'
+        }
+        line += ` ${word}`
+    }
+    lines.push(line)
+    return lines
+}
+
+function cppRecord(record) {
+    const lines = []
+    lines.push(...comment(record.doc))
+    lines.push(`struct ${record.name} {`)
+    lines.push(`    static constexpr size_t SIZE = ${recordSize(record)};`)
+    lines.push('')
+    for (const [name, type] of record.fields) {
+        lines.push(`    ${TYPES[type].cpp} ${name};`)
+    }
+
+    lines.push('')
+    lines.push('    void encode(char* out) const {')
+    let offset = 0
+    for (const [name, type] of record.fields) {
+        lines.push(
+            `        std::memcpy(out + ${offset}, &${name}, sizeof(${name}));`
+        )
+        offset += TYPES[type].size
+    }
+    lines.push('    }')
+
+    lines.push('')
+    lines.push(`    static ${record.name} decode(const char* in) {`)
+    lines.push(`        ${record.name} record;`)
+    offset = 0
+    for (const [name, type] of record.fields) {
+        const line =
+            `        std::memcpy(&record.${name}, in + ${offset}, ` +
+            `sizeof(record.${name}));`
+        if (line.length <= 80) {
+            lines.push(line)
+        } else {
+            lines.push(`        std::memcpy(&record.${name}, in + ${offset},`)
+            lines.push(`                    sizeof(record.${name}));`)
+        }
+        offset += TYPES[type].size
+    }
+    lines.push('        return record;')
+    lines.push('    }')
+    lines.push('};')
+    return lines.join('\n')
+}
+
+function generateCpp() {
+    return [
+        '#pragma once',
+        '',
+        BANNER,
+        '',
+        '#include <cstddef>',
+        '#include <cstdint>',
+        '#include <cstring>',
+        '',
+        cppEnum('ClientHeader', schema.clientHeaders),
+        '',
+        cppEnum('ServerHeader', schema.serverHeaders),
+        '',
+        'namespace Protocol {',
+        '',
+        `constexpr uint16_t VERSION = ${schema.version};`,
+        ...Object.entries(schema.constants).map(
+            ([name, value]) => `constexpr int ${name} = ${value};`
+        ),
+        '',
+        '// Fixed-layout records. SIZE is the exact wire size, so writers can',
+        '// reserve once and encode with a memcpy per field.',
+        '',
+        schema.records.map(cppRecord).join('\n\n'),
+        '',
+        '}  // namespace Protocol',
+        '',
+    ].join('\n')
+}
+
+function tsEnum(name, values) {
+    const lines = [`export const enum ${name} {`]
+    for (const value of values) lines.push(`    ${value},`)
+    lines.push('}')
+    return lines.join('\n')
+}
+
+function generateTsHeader() {
+    return [
+        BANNER,
+        '',
+        tsEnum('ClientHeader', schema.clientHeaders),
+        '',
+        tsEnum('ServerHeader', schema.serverHeaders),
+        '',
+    ].join('\n')
+}
+
+function tsRecord(record) {
+    const lines = []
+    lines.push(...comment(record.doc))
+    lines.push(`export interface ${record.name} {`)
+    for (const [name] of record.fields) lines.push(`    ${name}: number`)
+    lines.push('}')
+    lines.push('')
+    lines.push(
+        `export const ${constantName(record.name)}_SIZE = ${recordSize(record)}`
+    )
+    lines.push('')
+    lines.push(
+        `export function read${record.name}(reader: PacketReader): ` +
+            `${record.name} {`
+    )
+    lines.push('    return {')
+    for (const [name, type] of record.fields) {
+        lines.push(`        ${name}: reader.read${TYPES[type].ts}(),`)
+    }
+    lines.push('    }')
+    lines.push('}')
+    lines.push('')
+    lines.push(`export function write${record.name}(`)
+    lines.push('    writer: PacketWriter,')
+    lines.push(`    record: ${record.name}`)
+    lines.push('): void {')
+    for (const [name, type] of record.fields) {
+        lines.push(`    writer.write${TYPES[type].ts}(record.${name})`)
+    }
+    lines.push('}')
+    return lines.join('\n')
+}
+
+function generateTsRecords() {
+    return [
+        BANNER,
+        '',
+        "import { PacketReader } from './buffer/PacketReader'",
+        "import { PacketWriter } from './buffer/PacketWriter'",
+        '',
+        `export const PROTOCOL_VERSION = ${schema.version}`,
+        ...Object.entries(schema.constants).map(
+            ([name, value]) => `export const ${name} = ${value}`
+        ),
+        '',
+        schema.records.map(tsRecord).join('\n\n'),
+        '',
+    ].join('\n')
+}
+
+fs.writeFileSync(CPP_OUT, generateCpp())
+fs.writeFileSync(TS_HEADER_OUT, generateTsHeader())
+fs.writeFileSync(TS_RECORDS_OUT, generateTsRecords())
+
+for (const file of [CPP_OUT, TS_HEADER_OUT, TS_RECORDS_OUT]) {
+    console.log(`wrote ${path.relative(root, file)}`)
+}
@@ -0,0 +1,240 @@
+// Serialization micro-benchmarks. Build with -DBUILD_BENCHMARKS=ON and run
+// ./packet_bench from the build directory.
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "client/SnapshotHistory.hpp"
+#include "packet/Protocol.hpp"
+#include "packet/buffer/BitReader.hpp"
+#include "packet/buffer/BitWriter.hpp"
+#include "packet/buffer/PacketWriter.hpp"
+
+namespace {
+
+// roughly what a busy ENTITY_UPDATE looks like
+constexpr size_t ENTITY_COUNT = 200;
+constexpr int ITERATIONS = 20000;
+
+struct Entity {
+    uint16_t id;
+    int16_t x;
+    int16_t y;
+    uint16_t angle;
+    uint8_t state;
+};
+
+std::vector<Entity> makeEntities() {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> offset(-3840, 3840);
+    std::uniform_int_distribution<int> angle(0, 65535);
+    std::uniform_int_distribution<int> state(0, 3);
+
+    std::vector<Entity> entities;
+    uint16_t id = 0;
+    for (size_t i = 0; i < ENTITY_COUNT; ++i) {
+        id += 1 + (rng() % 4);
+        entities.push_back({id, static_cast<int16_t>(offset(rng)),
+                            static_cast<int16_t>(offset(rng)),
+                            static_cast<uint16_t>(angle(rng)),
+                            static_cast<uint8_t>(state(rng))});
+    }
+    return entities;
+}
+
+// the fixed-layout ENTITY_UPDATE entry used before delta snapshots
+struct UpdateRecord {
+    static constexpr size_t SIZE = 10;
+
+    uint32_t id;
+    int16_t x;
+    int16_t y;
+    uint16_t angle;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &id, sizeof(id));
+        std::memcpy(out + 4, &x, sizeof(x));
+        std::memcpy(out + 6, &y, sizeof(y));
+        std::memcpy(out + 8, &angle, sizeof(angle));
+    }
+};
+
+// the byte-at-a-time writer PacketWriter used to be, kept for comparison
+struct LegacyWriter {
+    std::string m_message;
+
+    template <class T>
+    void writeBytes(T data) {
+        const char* bytes = reinterpret_cast<const char*>(&data);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            m_message.push_back(bytes[i]);
+        }
+    }
+};
+
+template <class Fn>
+void run(const char* name, Fn&& fn) {
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        bytes = fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+
+    std::cout << name << ": " << ns / ITERATIONS << " ns/message, " << bytes
+              << " bytes" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+    const std::vector<Entity> entities = makeEntities();
+
+    // the ENTITY_UPDATE and ENTITY_STATE part of Client::writeGameState with
+    // a fresh buffer every tick, the way the writer used to behave
+    run("writeGameState, byte-at-a-time into a new buffer", [&]() {
+        LegacyWriter writer;
+        writer.writeBytes<uint8_t>(ServerHeader::ENTITY_UPDATE);
+        writer.writeBytes<float>(960.0f);
+        writer.writeBytes<float>(540.0f);
+        writer.writeBytes<uint32_t>(static_cast<uint32_t>(entities.size()));
+        for (const Entity& e : entities) {
+            writer.writeBytes<uint32_t>(e.id);
+            writer.writeBytes(e.x);
+            writer.writeBytes(e.y);
+            writer.writeBytes(e.angle);
+        }
+        for (const Entity& e : entities) {
+            if (e.state == 0) continue;
+            writer.writeBytes<uint8_t>(ServerHeader::ENTITY_STATE);
+            writer.writeBytes(e.id);
+            writer.writeBytes(e.state);
+        }
+        return writer.m_message.size();
+    });
+
+    // same output through a reused writer, reserved up front
+    PacketWriter snapshotWriter;
+    run("writeGameState, reserved records into a reused buffer", [&]() {
+        snapshotWriter.clear();
+        const size_t perEntity =
+            UpdateRecord::SIZE + 1 + Protocol::EntityState::SIZE;
+        snapshotWriter.reserve(5 + Protocol::SnapshotOrigin::SIZE +
+                               entities.size() * perEntity);
+        snapshotWriter.writeU8(ServerHeader::ENTITY_UPDATE);
+        snapshotWriter.writeRecord(Protocol::SnapshotOrigin{960.0f, 540.0f});
+        snapshotWriter.writeU32(static_cast<uint32_t>(entities.size()));
+        for (const Entity& e : entities) {
+            snapshotWriter.writeRecord(UpdateRecord{e.id, e.x, e.y, e.angle});
+        }
+        for (const Entity& e : entities) {
+            if (e.state == 0) continue;
+            snapshotWriter.writeU8(ServerHeader::ENTITY_STATE);
+            snapshotWriter.writeRecord(Protocol::EntityState{e.id, e.state});
+        }
+        return snapshotWriter.getMessage().size();
+    });
+
+    // appending a pre-serialized block, e.g. a broadcast shared by everyone
+    const std::string block(snapshotWriter.getMessage());
+    PacketWriter rawWriter;
+    run("appendRaw of the same snapshot", [&]() {
+        rawWriter.clear();
+        rawWriter.appendRaw(block);
+        return rawWriter.getMessage().size();
+    });
+
+    PacketWriter packetWriter;
+    run("PacketWriter (u32 id, i16 x/y, u16 angle, u8 state)", [&]() {
+        packetWriter.clear();
+        packetWriter.writeU32(static_cast<uint32_t>(entities.size()));
+        for (const Entity& e : entities) {
+            packetWriter.writeU32(e.id);
+            packetWriter.writeU16(static_cast<uint16_t>(e.x));
+            packetWriter.writeU16(static_cast<uint16_t>(e.y));
+            packetWriter.writeU16(e.angle);
+            packetWriter.writeU8(e.state);
+        }
+        return packetWriter.getMessage().size();
+    });
+
+    BitWriter bitWriter;
+    run("BitWriter (varint id delta, 14 bit x/y, 10 bit angle, 2 bit state)",
+        [&]() {
+            bitWriter.clear();
+            bitWriter.writeVarU32(static_cast<uint32_t>(entities.size()));
+            uint32_t previousId = 0;
+            for (const Entity& e : entities) {
+                bitWriter.writeVarU32(e.id - previousId);
+                bitWriter.writeBits(static_cast<uint16_t>(e.x >> 1) & 0x3FFF,
+                                    14);
+                bitWriter.writeBits(static_cast<uint16_t>(e.y >> 1) & 0x3FFF,
+                                    14);
+                bitWriter.writeBits(e.angle >> 6, 10);
+                bitWriter.writeBits(e.state, 2);
+                previousId = e.id;
+            }
+            return bitWriter.getMessage().size();
+        });
+
+    // decode what the bit writer produced and make sure it round trips
+    const std::string encoded(bitWriter.getMessage());
+    BitReader bitReader;
+    run("BitReader (same layout)", [&]() {
+        bitReader.loadMessage(encoded);
+        uint32_t count = bitReader.readVarU32();
+        uint32_t id = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            id += bitReader.readVarU32();
+            bitReader.readBits(14);
+            bitReader.readBits(14);
+            bitReader.readBits(10);
+            uint32_t state = bitReader.readBits(2);
+            if (id != entities[i].id || state != entities[i].state) {
+                std::cerr << "BitReader mismatch at " << i << std::endl;
+                std::exit(1);
+            }
+        }
+        return bitReader.byteLength();
+    });
+
+    run("BitWriter zig-zag varints", [&]() {
+        bitWriter.clear();
+        for (const Entity& e : entities) {
+            bitWriter.writeVarS32(e.x);
+            bitWriter.writeVarS32(e.y);
+        }
+        return bitWriter.getMessage().size();
+    });
+
+    // delta snapshot against an acked baseline where a quarter of the
+    // entities moved since, what ENTITY_UPDATE sends now
+    std::vector<EntitySnapshot> baseline;
+    std::vector<EntitySnapshot> current;
+    for (size_t i = 0; i < entities.size(); ++i) {
+        const Entity& e = entities[i];
+        baseline.push_back({e.id, e.x, e.y, e.angle});
+        current.push_back(baseline.back());
+        if (i % 4 == 0) {
+            current.back().x += 12;
+            current.back().y -= 5;
+        }
+    }
+    run("SnapshotHistory::writeDelta, 1 in 4 entities moved", [&]() {
+        bitWriter.clear();
+        SnapshotHistory::writeDelta(bitWriter, &baseline, current);
+        return bitWriter.getMessage().size();
+    });
+    run("SnapshotHistory::writeDelta, keyframe", [&]() {
+        bitWriter.clear();
+        SnapshotHistory::writeDelta(bitWriter, nullptr, current);
+        return bitWriter.getMessage().size();
+    });
+
+    return 0;
+}
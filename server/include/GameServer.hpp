@@ -1,7 +1,5 @@
 #pragma once
 
-#include <uwebsockets/Loop.h>
-
 #include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
@@ -13,7 +11,11 @@
 #include "World.hpp"
 #include "client/Client.hpp"
 #include "ecs/EntityManager.hpp"
+#include "network/SocketLoop.hpp"
+#include "packet/Protocol.hpp"
 #include "physics/PhysicsWorld.hpp"
+#include "physics/SpatialGrid.hpp"
+#include "util/ThreadPool.hpp"
 
 class Client;
 class GameServer {
@@ -21,7 +23,8 @@ class GameServer {
     GameServer();
     ~GameServer() = default;
 
-    uWS::Loop* m_socketLoop = nullptr;
+    // one per socket thread, registered before the socket threads start
+    std::vector<SocketLoop*> m_socketLoops;
 
     std::mutex m_gameMutex;
 
@@ -29,16 +32,29 @@ class GameServer {
     uint64_t m_currentTick = 0;
 
     GameConfig m_gameConfig;
+    // ENTITY_UPDATE bytes per client per tick, lower priority changes wait
+    size_t m_snapshotBudget = 1200;
+    // threads that serialize client snapshots, counting the game thread.
+    // 0 uses every hardware thread. main passes the threads the socket loops
+    // leave free when SERIALIZE_THREADS is unset.
+    size_t m_serializeThreads = 0;
 
     EntityManager m_entityManager;
     PhysicsWorld m_physicsWorld;
     std::unique_ptr<World> m_worldGenerator;
     std::unique_ptr<RaycastSystem> m_raycastSystem;
+    // networked entities by position, a viewport spans a handful of cells
+    SpatialGrid m_spatialGrid{10.0f};
     std::unordered_map<uint32_t, Client*> m_clients;
     std::vector<TerrainMesh> m_terrainMeshes;
 
-    // incoming network messages
-    std::vector<std::pair<uint32_t, std::string>> m_messages;
+    // Events every client receives (joins, leaves, news, traces). Written
+    // once and shared by all clients at the end of the tick.
+    PacketWriter m_broadcastWriter;
+
+    // Serialized once at startup and queued as-is on every client
+    SharedBuffer m_handshakeBuffer;  // PROTOCOL, TPS, MAP_INIT, GAME_CONFIG
+    SharedBuffer m_terrainBuffer;    // every BIOME_CREATE mesh
 
     // Server registration
     ServerRegistration* m_serverRegistration = nullptr;
@@ -49,9 +65,55 @@ class GameServer {
     void setServerRegistration(ServerRegistration* registration);
 
    private:
-    std::vector<uint32_t> m_projectileDestroyQueue;
-
+    // fn(client) for every client that currently knows about the entity
+    template <class Fn>
+    void forEachObserver(entt::entity entity, Fn&& fn);
+    // Drop a projectile (or fan) id from the visible sets of the clients
+    // that were told about it, without a message. Net id generations wrap,
+    // so a stale entry would hide whatever reuses the id later.
+    void forgetProjectile(entt::entity entity, uint16_t netId);
+
+    // What every projectile and live pellet travelled this tick, and every
+    // hitscan trace, bucketed by cell so each client only tests the flights
+    // near its camera
+    struct ProjectileFlight {
+        enum Kind : uint8_t { PROJECTILE, FAN, TRACE };
+
+        Kind kind;
+        uint16_t netId;
+        entt::entity entity;
+        uint32_t trace;  // into m_bulletTraces
+        b2Vec2 from;
+        b2Vec2 to;
+    };
+    std::vector<ProjectileFlight> m_projectileFlights;
+
+    struct QueuedTrace {
+        Protocol::BulletTrace record;
+        b2Vec2 from;  // meters
+        b2Vec2 to;
+        // a trace spanning several cells is only sent once per client
+        uint32_t sentTo = UINT32_MAX;
+    };
+    std::vector<QueuedTrace> m_bulletTraces;
+    CellBuckets m_projectileCells{10.0f};
+    // networked entities created since the last grid update, their bodies
+    // may not exist yet when the component is added
+    std::vector<entt::entity> m_gridPending;
+
+    // started by run(), clients are serialized in parallel after the
+    // simulation
+    std::unique_ptr<ThreadPool> m_serializePool;
+    std::vector<GameStateScratch> m_gameStateScratch;
+    std::vector<Client*> m_serializeClients;
+
+    void onNetworkedCreated(entt::registry& reg, entt::entity entity);
+    void onNetworkedDestroyed(entt::registry& reg, entt::entity entity);
+
+    void buildJoinBuffers();
+    bool socketsReady() const;
     void processClientMessages();
+    void flushBroadcasts();
     void tick(double delta);
     void prePhysicsSystemUpdate(double delta);
     void postPhysicsSystemUpdate(double delta);
@@ -61,7 +123,9 @@ class GameServer {
     void meleeSystem(double delta);
     void gunSystem(double delta);
     void projectileSystem(double delta);
+    void pelletFanSystem(double delta);
     void projectileImpactSystem();
+    void spatialGridSystem();
     void pickupSystem();
     void processPickupContactBegin(const b2ContactEvents& events);
     void processPickupContactEnd(const b2ContactEvents& events);
@@ -77,9 +141,11 @@ class GameServer {
 
     void broadcastKill(entt::entity subject);
     void broadcastMessage(const std::string& message);
-    void broadcastBulletTrace(entt::entity shooter, glm::vec2 start,
-                              glm::vec2 end);
-    void flushProjectileSpawnBatch();
+    void queueBulletTrace(entt::entity shooter, glm::vec2 start,
+                          glm::vec2 end);
+    // delta is the tick the simulation just advanced by
+    void indexProjectileFlights(double delta);
+    void flushProjectileSpawnBatch(double delta);
     void flushProjectileDestroyBatch();
 
     void processJobs();
@@ -1,18 +1,29 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include "GameServer.hpp"
+#include "network/SocketConfig.hpp"
+#include "network/SocketLoop.hpp"
 
 class SocketServer {
    public:
-    SocketServer(GameServer& gameServer, uint16_t port);
+    // Starts config.threads socket threads, each running its own uWS app on
+    // the same port. The kernel spreads new connections across them.
+    SocketServer(GameServer& gameServer, uint16_t port,
+                 const SocketConfig& config);
 
    private:
     uint16_t m_port;
     GameServer& m_gameServer;
-    std::thread m_socketThread;
+    SocketConfig m_config;
+    std::atomic<uint32_t> m_nextClientId{0};
+    std::vector<std::unique_ptr<SocketLoop>> m_loops;
+    std::vector<std::thread> m_socketThreads;
 
-    void run();
+    void run(SocketLoop& loop);
 };
@@ -1,12 +1,24 @@
 #pragma once
 
+#include <box2d/box2d.h>
 #include <uwebsockets/WebSocket.h>
 #include <uwebsockets/WebSocketData.h>
 
+#include <atomic>
 #include <cstdint>
 #include <entt/entt.hpp>
+#include <unordered_map>
 #include <unordered_set>
-
+#include <utility>
+#include <vector>
+
+#include "client/SnapshotHistory.hpp"
+#include "ecs/NetIdAllocator.hpp"
+#include "network/InputSlot.hpp"
+#include "network/SocketConfig.hpp"
+#include "network/TokenBucket.hpp"
+#include "packet/Protocol.hpp"
+#include "packet/buffer/BitWriter.hpp"
 #include "packet/buffer/PacketReader.hpp"
 #include "packet/buffer/PacketWriter.hpp"
 
@@ -15,6 +27,25 @@ class GameServer;
 
 struct WebSocketData {
     uint32_t id;
+
+    // inbound limits, only touched on the socket thread
+    TokenBucket messageBudget;
+    TokenBucket byteBudget;
+    uint64_t rejectedFrames = 0;
+    uint64_t malformedFrames = 0;
+    uint64_t droppedFrames = 0;  // lost to a full inbound queue
+
+    // written by the socket thread, taken by the game thread each tick
+    InputSlot input;
+};
+
+// Containers writeGameState reuses between calls. One per serializing
+// thread, so clients can be written in parallel.
+struct GameStateScratch {
+    // (net id, entity), sorted by net id
+    std::vector<std::pair<uint16_t, entt::entity>> visible;
+    std::vector<entt::entity> createEntities;
+    std::vector<uint16_t> removeIds;
 };
 
 class Client {
@@ -26,15 +57,22 @@ class Client {
 
     uWS::WebSocket<false, true, WebSocketData>* m_ws;
     PacketReader m_reader;
+    // filled by the game thread, handed to the socket thread by publish()
     PacketWriter m_writer;
+    // per-tick entity positions and states, superseded by the next tick
+    PacketWriter m_snapshotWriter;
 
     std::string m_name;
     // we are actively playing inside the game world, spectators are inactive
     bool m_active = false;
     bool m_sentTerrainMeshes = false;
-    std::unordered_set<entt::entity> m_previousVisibleEntities;
+    // sorted by net id, so entities that were destroyed can still be removed
+    std::vector<std::pair<uint16_t, entt::entity>> m_previousVisible;
     std::unordered_set<size_t> m_previousVisibleBiomes;
-    std::unordered_set<uint32_t> m_visibleProjectiles;
+    NetIdSet m_visibleProjectiles;
+    // impacts of projectiles this client was told about, sent at tick end
+    std::vector<uint16_t> m_projectileDestroys;
+    std::vector<Protocol::PelletImpact> m_pelletImpacts;
 
     Client(GameServer& gameServer,
            uWS::WebSocket<false, true, WebSocketData>* ws, uint32_t id);
@@ -46,21 +84,66 @@ class Client {
 
     void onSpawn();
     void onClose();
-    void onMovement();
-    void onMouse();
-    void onMouseClick(bool isDown);
     void onChat();
-    void onReload();
-    void onSwitchItem();
-    void onPickupRequest();
+    // apply the inputs the socket thread coalesced since the last tick
+    void applyInput();
 
     void updateCamera();
 
-    void writeGameState();
-    void sendBytes();
+    // Only writes to this client's buffers and its own entity's components,
+    // so different clients may be written from different threads.
+    void writeGameState(GameStateScratch& scratch);
+    // game thread, after every client was written: apply this tick's
+    // visibility changes to the entities' Observers
+    void updateObservers();
+    // queue pre-serialized bytes to go out ahead of the next frame
+    void queueSharedBuffer(const SharedBuffer& buffer);
+    // game thread: hand the current frame over to the socket thread
+    void publish();
+    enum class SendResult { SENT, SNAPSHOT_SKIPPED, OVER_LIMIT };
+    // socket thread: send the frame handed over by publish()
+    SendResult sendBytes(const SocketConfig& config);
 
    private:
     void sendTerrainMeshes();
+    // writes m_updateEntities
+    void writeEntityUpdates(const b2Vec2& camera);
+    // defer the lowest priority changes that do not fit m_snapshotBudget
+    void applyUpdateBudget(const std::vector<EntitySnapshot>* baseline,
+                           const b2Vec2& camera);
+    float updateWeight(entt::entity entity, const b2Vec2& camera);
+
+    std::vector<SharedBuffer> m_sharedBuffers;
+
+    // visibility changes from writeGameState, which may run off the game
+    // thread and so cannot touch the registry's Observers itself
+    std::vector<entt::entity> m_startedObserving;
+    std::vector<entt::entity> m_stoppedObserving;
+
+    // ENTITY_UPDATE is delta encoded against the newest snapshot the client
+    // acked, so entities that have not changed since then cost nothing
+    SnapshotHistory m_snapshots;
+    std::vector<EntitySnapshot> m_currentSnapshot;
+    // visible dynamic entities the client already knows, sorted by net id
+    std::vector<std::pair<uint16_t, entt::entity>> m_updateEntities;
+    BitWriter m_deltaWriter;
+    uint32_t m_ackedTick = 0;
+
+    struct UpdateCandidate {
+        size_t index;  // into m_currentSnapshot
+        const EntitySnapshot* baseline;
+        float priority;
+        size_t bits;
+    };
+    std::vector<UpdateCandidate> m_updateCandidates;
+    // accumulated send priority of each visible entity, reset once sent
+    std::unordered_map<uint16_t, float> m_updatePriority;
+
+    // Back buffers owned by the socket thread while m_sendPending is set
+    PacketWriter m_sendWriter;
+    PacketWriter m_sendSnapshotWriter;
+    std::vector<SharedBuffer> m_sendSharedBuffers;
+    std::atomic<bool> m_sendPending{false};
 
    private:
     GameServer& m_gameServer;
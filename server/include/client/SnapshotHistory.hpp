@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "packet/buffer/BitWriter.hpp"
+
+// One entity's networked transform as the client reconstructs it. Positions
+// are absolute, in 1/POSITION_SCALE pixel steps, so an entity that did not
+// move compares equal no matter where the camera went.
+struct EntitySnapshot {
+    uint16_t id;
+    int32_t x;
+    int32_t y;
+    uint16_t angle;
+};
+
+// Recent ENTITY_UPDATE snapshots sent to one client, each sorted by id. The
+// client acks the ticks it received and the newest acked one becomes the
+// baseline the next snapshot is delta encoded against.
+class SnapshotHistory {
+   public:
+    static constexpr size_t SIZE = 32;
+
+    // nullptr once the tick has been overwritten (or was never stored)
+    const std::vector<EntitySnapshot>* find(uint32_t tick) const;
+    // swaps `entities` into the slot, handing back the slot's old buffer
+    void store(uint32_t tick, std::vector<EntitySnapshot>& entities);
+
+    // Write one entry per entity that differs from `baseline` (nullptr for a
+    // keyframe) and return the entry count. Both lists must be sorted by id.
+    static uint32_t writeDelta(BitWriter& writer,
+                               const std::vector<EntitySnapshot>* baseline,
+                               const std::vector<EntitySnapshot>& current);
+
+    // Size of the entry writeDelta emits for `current` (previous is nullptr
+    // when it is not in the baseline). The id gap depends on the neighbours
+    // and is counted as one byte.
+    static size_t entryBits(const EntitySnapshot* previous,
+                            const EntitySnapshot& current);
+
+   private:
+    struct Slot {
+        uint32_t tick = 0;
+        std::vector<EntitySnapshot> entities;
+    };
+
+    std::array<Slot, SIZE> m_slots;
+};
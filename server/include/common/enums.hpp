@@ -2,41 +2,8 @@
 
 #include <cstdint>
 
-enum ClientHeader : uint8_t {
-    SPAWN,
-    MOUSE,
-    MOVEMENT,
-    MOUSE_DOWN,
-    MOUSE_UP,
-    CLIENT_CHAT,
-    RELOAD,
-    SWITCH_ITEM,
-    PICKUP_REQUEST,
-};
-
-enum ServerHeader : uint8_t {
-    SPAWN_SUCCESS,
-    SET_CAMERA,
-    ENTITY_CREATE,
-    ENTITY_UPDATE,
-    ENTITY_REMOVE,
-    PLAYER_JOIN,
-    PLAYER_LEAVE,
-    ENTITY_STATE,
-    HEALTH,
-    DIED,
-    TPS,
-    NEWS,
-    SERVER_CHAT,
-    MAP_INIT,
-    BIOME_CREATE,
-    INVENTORY_UPDATE,
-    AMMO_UPDATE,
-    BULLET_TRACE,
-    PROJECTILE_SPAWN_BATCH,
-    PROJECTILE_DESTROY,
-    GAME_CONFIG,
-};
+// ClientHeader and ServerHeader are generated from protocol/schema.json
+#include "packet/Protocol.hpp"
 
 enum NewsType : uint8_t {
     TEXT,
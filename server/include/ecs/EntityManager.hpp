@@ -1,11 +1,14 @@
 #pragma once
 
+#include <box2d/math_functions.h>
+
 #include <cstdint>
 #include <entt/entt.hpp>
 #include <unordered_map>
 #include <vector>
 
 #include "common/enums.hpp"
+#include "ecs/NetIdAllocator.hpp"
 
 namespace Components {
 struct Gun;
@@ -43,6 +46,8 @@ class EntityManager {
     entt::entity createProjectileEntity();
     std::vector<entt::entity> m_projectilePool;
 
+    NetIdAllocator m_netIds;
+
    public:
     EntityManager(GameServer& gameServer);
 
@@ -51,6 +56,10 @@ class EntityManager {
 
     entt::registry& getRegistry() { return m_registry; }
 
+    // the id clients know this entity by, NetIdAllocator::NULL_ID for
+    // entities that are not networked (or no longer exist)
+    uint16_t getNetId(entt::entity entity) const;
+
     // Max amount of variants per EntityType
     std::unordered_map<EntityTypes, uint8_t> m_variants;
     uint8_t getVariantCount(EntityTypes type);
@@ -68,9 +77,16 @@ class EntityManager {
                                   float y);
 
     void initProjectilePool(size_t count);
+    // entt::null when no net id is free
     entt::entity acquireProjectile();
     void releaseProjectile(entt::entity entity);
 
+    // one entity for every pellet of a multi-pellet shot, origin is the
+    // muzzle in meters. entt::null when no net id is free.
+    entt::entity createPelletFan(entt::entity owner,
+                                 const Components::Gun& gun, uint64_t tick,
+                                 b2Vec2 origin, float angle);
+
     void scheduleForRemoval(entt::entity entity);
     void removeEntities();
     entt::entity getFollowEntity();
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "packet/Protocol.hpp"
+
+// Dense 16-bit ids for the entities clients know about. The low 12 bits
+// index a slot and the high 4 bits are the slot's generation, bumped every
+// time the slot is freed, so a late message about a recycled slot never
+// matches the new owner. Freed slots are reused oldest first.
+class NetIdAllocator {
+   public:
+    static constexpr uint16_t NULL_ID = Protocol::NULL_NET_ID;
+    static constexpr unsigned int INDEX_BITS = 12;
+    static constexpr uint16_t INDEX_MASK = (1 << INDEX_BITS) - 1;
+    // the last slot's final generation would collide with NULL_ID
+    static constexpr size_t CAPACITY = (1 << INDEX_BITS) - 1;
+
+    NetIdAllocator();
+
+    // NULL_ID when every slot is taken, logged once until a slot frees up
+    uint16_t allocate();
+    void release(uint16_t id);
+
+    static size_t index(uint16_t id) { return id & INDEX_MASK; }
+
+   private:
+    std::array<uint16_t, CAPACITY> m_ids;
+    std::deque<uint16_t> m_free;
+    bool m_exhausted = false;
+};
+
+// Flat membership table keyed by net id index. Slots hold the full id, so a
+// recycled index does not read as a member.
+class NetIdSet {
+   public:
+    NetIdSet() { m_ids.fill(NetIdAllocator::NULL_ID); }
+
+    // false if the id was already present (or is NULL_ID)
+    bool insert(uint16_t id) {
+        if (id == NetIdAllocator::NULL_ID) return false;
+        uint16_t& slot = m_ids[NetIdAllocator::index(id)];
+        if (slot == id) return false;
+        slot = id;
+        return true;
+    }
+
+    bool contains(uint16_t id) const {
+        return id != NetIdAllocator::NULL_ID &&
+               m_ids[NetIdAllocator::index(id)] == id;
+    }
+
+    // false if the id was not present
+    bool erase(uint16_t id) {
+        if (id == NetIdAllocator::NULL_ID) return false;
+        uint16_t& slot = m_ids[NetIdAllocator::index(id)];
+        if (slot != id) return false;
+        slot = NetIdAllocator::NULL_ID;
+        return true;
+    }
+
+   private:
+    std::array<uint16_t, NetIdAllocator::CAPACITY> m_ids;
+};
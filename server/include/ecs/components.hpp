@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <entt/entt.hpp>
 #include <unordered_set>
+#include <vector>
 
 #include "common/enums.hpp"
 #include "ecs/EntityManager.hpp"
@@ -23,8 +24,27 @@ struct EntityBase {
     b2BodyId bodyId = b2_nullBodyId;
 };
 
-struct Networked {};
+// net id is assigned by EntityManager and freed when the entity is destroyed
+struct Networked {
+    uint16_t netId = NetIdAllocator::NULL_ID;
+};
 struct Removal {};
+// pooled projectiles in flight, so systems skip the idle part of the pool
+struct ActiveProjectile {};
+
+// Ids of the clients that currently know about this entity, kept up to date
+// by the visibility diff. Events about one entity go to these clients only.
+struct Observers {
+    std::vector<uint32_t> clients;
+
+    void add(uint32_t client) { clients.push_back(client); }
+    void remove(uint32_t client) {
+        auto it = std::find(clients.begin(), clients.end(), client);
+        if (it == clients.end()) return;
+        *it = clients.back();
+        clients.pop_back();
+    }
+};
 
 struct Camera {
     entt::entity target;
@@ -253,7 +273,11 @@ struct GroundItem {
 };
 
 struct Projectile {
+    // allocated per flight, pooled entities get a fresh id each time
+    uint16_t netId = NetIdAllocator::NULL_ID;
     entt::entity owner = entt::null;
+    // clients look the speed up from the weapon's config
+    ItemType weapon = ItemType::ITEM_NONE;
     float damage = 0.0f;
     float remainingLife = 0.0f;
     bool active = false;
@@ -269,6 +293,7 @@ struct Projectile {
               float spawnX, float spawnY, float directionX, float directionY,
               float projectileSpeed) {
         owner = ownerEntity;
+        weapon = gun.itemType;
         damage = gun.damage;
         remainingLife = gun.projectileLifetime;
         active = true;
@@ -281,4 +306,32 @@ struct Projectile {
     }
 };
 
+// A multi-pellet shot. The pellets are rays grouped under one entity instead
+// of a Box2D body each, their directions come from the seed.
+struct PelletFan {
+    // one bit per pellet in the alive mask
+    static constexpr int MAX_PELLETS = Protocol::FAN_MAX_PELLETS;
+
+    uint16_t netId = NetIdAllocator::NULL_ID;
+    entt::entity owner = entt::null;
+    ItemType weapon = ItemType::ITEM_NONE;
+    float damage = 0.0f;
+    float remainingLife = 0.0f;
+    uint64_t spawnTick = 0;
+    b2Vec2 origin = {0.0f, 0.0f};  // meters, muzzle along the aim angle
+    float angle = 0.0f;
+    float speed = 0.0f;      // meters per second
+    float travelled = 0.0f;  // meters, the same for every pellet
+    uint16_t seed = 0;
+    uint8_t pellets = 0;
+    uint16_t alive = 0;  // bit per pellet still in flight
+    std::array<b2Vec2, MAX_PELLETS> directions;
+
+    // where a pellet currently is, in meters
+    b2Vec2 head(int pellet) const {
+        return {origin.x + directions[pellet].x * travelled,
+                origin.y + directions[pellet].y * travelled};
+    }
+};
+
 };  // namespace Components
\ No newline at end of file
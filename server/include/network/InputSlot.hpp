@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Latest-wins input state for one client. The socket thread folds mouse,
+// movement and button messages in as they arrive and the game thread takes
+// one snapshot per tick, so a burst of pointer moves costs a single read.
+struct InputSlot {
+    // one-shot actions, OR'd together until the next tick consumes them
+    enum Edge : uint8_t {
+        CLICK = 1 << 0,
+        RELOAD = 1 << 1,
+        PICKUP = 1 << 2,
+    };
+
+    struct State {
+        float angle;
+        uint8_t direction;
+        bool mouseDown;
+        uint8_t edges;
+        int8_t switchSlot;
+        uint32_t snapshotAck;
+    };
+
+    std::atomic<float> angle{0.0f};
+    std::atomic<uint8_t> direction{0};
+    std::atomic<bool> mouseDown{false};
+    std::atomic<uint8_t> edges{0};
+    std::atomic<int8_t> switchSlot{-1};
+    // newest ENTITY_UPDATE tick the client has received
+    std::atomic<uint32_t> snapshotAck{0};
+
+    // game thread: read the latest values and consume pending edges
+    State take() {
+        State state;
+        state.angle = angle.load(std::memory_order_relaxed);
+        state.direction = direction.load(std::memory_order_relaxed);
+        state.mouseDown = mouseDown.load(std::memory_order_relaxed);
+        state.edges = edges.exchange(0, std::memory_order_relaxed);
+        state.switchSlot = switchSlot.exchange(-1, std::memory_order_relaxed);
+        state.snapshotAck = snapshotAck.load(std::memory_order_relaxed);
+        return state;
+    }
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+// Single-producer/single-consumer queue of inbound websocket frames backed by
+// a fixed byte ring. The socket thread pushes each frame with one memcpy and
+// the game thread drains everything that is available in one batch, so the
+// two threads never share a lock. Ring memory is recycled once drained.
+class MessageQueue {
+   public:
+    explicit MessageQueue(size_t capacity = 1 << 22);
+
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator=(const MessageQueue&) = delete;
+
+    // Producer side. Returns false (and counts a drop) when the ring is full
+    // or the frame could never fit.
+    bool push(uint32_t clientId, std::string_view payload);
+
+    // Consumer side. Invokes fn(clientId, payload) for every queued frame; the
+    // payload view is only valid for the duration of the call.
+    template <class Fn>
+    size_t drain(Fn&& fn);
+
+    uint64_t droppedCount() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+   private:
+    struct RecordHeader {
+        uint32_t clientId;
+        uint32_t length;
+    };
+
+    static constexpr uint32_t WRAP_MARKER = UINT32_MAX;
+    static constexpr size_t ALIGNMENT = alignof(uint64_t);
+
+    static size_t recordSize(size_t payloadLength) {
+        size_t size = sizeof(RecordHeader) + payloadLength;
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_capacity;
+    size_t m_mask;
+
+    // head is only written by the producer, tail only by the consumer
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    uint64_t m_cachedTail = 0;
+    alignas(64) std::atomic<uint64_t> m_tail{0};
+    std::atomic<uint64_t> m_dropped{0};
+};
+
+template <class Fn>
+size_t MessageQueue::drain(Fn&& fn) {
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    const uint64_t head = m_head.load(std::memory_order_acquire);
+
+    size_t count = 0;
+    while (tail != head) {
+        const size_t offset = tail & m_mask;
+
+        RecordHeader header;
+        std::memcpy(&header, m_buffer.get() + offset, sizeof(header));
+
+        if (header.length == WRAP_MARKER) {
+            tail += m_capacity - offset;
+            continue;
+        }
+
+        fn(header.clientId,
+           std::string_view(m_buffer.get() + offset + sizeof(header),
+                            header.length));
+
+        tail += recordSize(header.length);
+        ++count;
+    }
+
+    // hand the whole batch back to the producer at once
+    m_tail.store(tail, std::memory_order_release);
+    return count;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <uwebsockets/WebSocket.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+// Socket layer settings, read from the environment in main
+struct SocketConfig {
+    unsigned int threads = 1;
+
+    // permessage-deflate mode offered to clients
+    uWS::CompressOptions compression = uWS::SHARED_COMPRESSOR;
+    // frames smaller than this are sent uncompressed, so per-tick snapshots
+    // skip deflate while join payloads (config, terrain) get compressed
+    size_t compressionThreshold = 1024;
+
+    // once a client has this many bytes queued, position snapshots are
+    // skipped until it catches up; reliable events are still sent
+    size_t sendWatermark = 64 * 1024;
+    // clients with more than this queued are disconnected
+    size_t sendLimit = 1024 * 1024;
+
+    // inbound frames larger than this close the connection
+    unsigned int maxPayloadLength = 4 * 1024;
+    // per-client token buckets; a frame over budget closes the connection
+    // on the socket thread. The client batches input at the tick rate and
+    // flushes edge events (clicks, reload, chat) at once, so these leave
+    // plenty of headroom. Zero disables a limit.
+    double messageRate = 120.0;
+    double messageBurst = 240.0;
+    double byteRate = 32.0 * 1024;
+    double byteBurst = 64.0 * 1024;
+    // connections that send more truncated or unparseable frames than this
+    // are closed
+    unsigned int maxMalformedFrames = 10;
+
+    static uWS::CompressOptions parseCompression(const std::string& value) {
+        if (value == "off") return uWS::DISABLED;
+        if (value == "shared") return uWS::SHARED_COMPRESSOR;
+        if (value == "dedicated") return uWS::DEDICATED_COMPRESSOR;
+        throw std::runtime_error("Invalid WS_COMPRESSION: " + value);
+    }
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <uwebsockets/Loop.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "network/MessageQueue.hpp"
+#include "network/SocketConfig.hpp"
+#include "packet/buffer/PacketReader.hpp"
+
+class Client;
+struct WebSocketData;
+
+// Per socket thread state. Connections are only added, removed and flushed on
+// the owning socket thread, so sending never has to take the game mutex.
+class SocketLoop {
+   public:
+    explicit SocketLoop(const SocketConfig& config) : m_config(config) {}
+
+    SocketLoop(const SocketLoop&) = delete;
+    SocketLoop& operator=(const SocketLoop&) = delete;
+
+    // frames received by this thread, drained by the game thread each tick
+    MessageQueue m_messages;
+
+    enum class ReceiveResult { OK, QUEUE_FULL, MALFORMED };
+    // Socket thread: fold state-type inputs into the client's input slot and
+    // queue whatever is left (spawn, chat) for the game thread. Messages
+    // before a malformed one are still applied.
+    ReceiveResult receive(WebSocketData& data, std::string_view message);
+
+    // Called from the socket thread once it is listening
+    void setLoop(uWS::Loop* loop);
+    bool isReady() const;
+
+    void addConnection(Client* client);
+    void removeConnection(Client* client);
+
+    // Schedule a send of every client's published frame on the socket thread.
+    // Safe to call from the game thread.
+    void deferFlush();
+
+    uint64_t skippedSnapshots() const {
+        return m_skippedSnapshots.load(std::memory_order_relaxed);
+    }
+    uint64_t slowDisconnects() const {
+        return m_slowDisconnects.load(std::memory_order_relaxed);
+    }
+
+    void recordRejectedFrame() {
+        m_rejectedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t rejectedFrames() const {
+        return m_rejectedFrames.load(std::memory_order_relaxed);
+    }
+    uint64_t malformedFrames() const {
+        return m_malformedFrames.load(std::memory_order_relaxed);
+    }
+    void recordDroppedFrame() {
+        m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t droppedFrames() const {
+        return m_droppedFrames.load(std::memory_order_relaxed);
+    }
+
+   private:
+    const SocketConfig& m_config;
+    std::atomic<uWS::Loop*> m_loop{nullptr};
+    std::vector<Client*> m_connections;
+    std::vector<Client*> m_overLimit;
+
+    // scratch state for receive(), reused across frames
+    PacketReader m_reader;
+    std::string m_forward;
+
+    std::atomic<uint64_t> m_skippedSnapshots{0};
+    std::atomic<uint64_t> m_slowDisconnects{0};
+    std::atomic<uint64_t> m_rejectedFrames{0};
+    std::atomic<uint64_t> m_malformedFrames{0};
+    std::atomic<uint64_t> m_droppedFrames{0};
+
+    void flush();
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+// Refills at `rate` tokens per second up to `burst`. A rate of zero disables
+// the limit. Not thread safe; each bucket is owned by one socket thread.
+class TokenBucket {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    TokenBucket() = default;
+    TokenBucket(double rate, double burst)
+        : m_rate(rate), m_burst(burst), m_tokens(burst), m_last(Clock::now()) {}
+
+    // Refills up to `now` and reports whether `tokens` could be spent,
+    // without spending them
+    bool canConsume(double tokens, Clock::time_point now) {
+        if (m_rate <= 0.0) return true;
+
+        double elapsed = std::chrono::duration<double>(now - m_last).count();
+        m_last = now;
+        m_tokens = std::min(m_burst, m_tokens + elapsed * m_rate);
+        return m_tokens >= tokens;
+    }
+
+    bool consume(double tokens, Clock::time_point now) {
+        if (!canConsume(tokens, now)) return false;
+        if (m_rate > 0.0) m_tokens -= tokens;
+        return true;
+    }
+
+   private:
+    double m_rate = 0.0;
+    double m_burst = 0.0;
+    double m_tokens = 0.0;
+    Clock::time_point m_last;
+};
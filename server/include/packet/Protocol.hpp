@@ -0,0 +1,323 @@
+#pragma once
+
+// Generated by scripts/generate-protocol.js from protocol/schema.json.
+// Do not edit by hand.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+enum ClientHeader : uint8_t {
+    SPAWN,
+    MOUSE,
+    MOVEMENT,
+    MOUSE_DOWN,
+    MOUSE_UP,
+    CLIENT_CHAT,
+    RELOAD,
+    SWITCH_ITEM,
+    PICKUP_REQUEST,
+    SNAPSHOT_ACK,
+};
+
+enum ServerHeader : uint8_t {
+    SPAWN_SUCCESS,
+    SET_CAMERA,
+    ENTITY_CREATE,
+    ENTITY_UPDATE,
+    ENTITY_REMOVE,
+    PLAYER_JOIN,
+    PLAYER_LEAVE,
+    ENTITY_STATE,
+    HEALTH,
+    DIED,
+    TPS,
+    NEWS,
+    SERVER_CHAT,
+    MAP_INIT,
+    BIOME_CREATE,
+    INVENTORY_UPDATE,
+    AMMO_UPDATE,
+    BULLET_TRACE,
+    PROJECTILE_SPAWN_BATCH,
+    PROJECTILE_DESTROY,
+    GAME_CONFIG,
+    PROTOCOL,
+};
+
+namespace Protocol {
+
+constexpr uint16_t VERSION = 7;
+constexpr int POSITION_SCALE = 4;
+constexpr int NULL_NET_ID = 65535;
+constexpr int SNAPSHOT_REMOVED = 0;
+constexpr int SNAPSHOT_CHANGED = 1;
+constexpr int SNAPSHOT_FULL = 2;
+constexpr int FAN_MAX_PELLETS = 16;
+
+// Fixed-layout records. SIZE is the exact wire size, so writers can
+// reserve once and encode with a memcpy per field.
+
+// Camera centre in pixels, sent before ENTITY_CREATE and PROJECTILE_SPAWN_BATCH
+// entries
+struct SnapshotOrigin {
+    static constexpr size_t SIZE = 8;
+
+    float x;
+    float y;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &x, sizeof(x));
+        std::memcpy(out + 4, &y, sizeof(y));
+    }
+
+    static SnapshotOrigin decode(const char* in) {
+        SnapshotOrigin record;
+        std::memcpy(&record.x, in + 0, sizeof(record.x));
+        std::memcpy(&record.y, in + 4, sizeof(record.y));
+        return record;
+    }
+};
+
+// ENTITY_CREATE entry, followed by PickupInfo for pickups
+struct EntityCreate {
+    static constexpr size_t SIZE = 10;
+
+    uint16_t id;
+    uint8_t type;
+    uint8_t variant;
+    int16_t x;
+    int16_t y;
+    uint16_t angle;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &id, sizeof(id));
+        std::memcpy(out + 2, &type, sizeof(type));
+        std::memcpy(out + 3, &variant, sizeof(variant));
+        std::memcpy(out + 4, &x, sizeof(x));
+        std::memcpy(out + 6, &y, sizeof(y));
+        std::memcpy(out + 8, &angle, sizeof(angle));
+    }
+
+    static EntityCreate decode(const char* in) {
+        EntityCreate record;
+        std::memcpy(&record.id, in + 0, sizeof(record.id));
+        std::memcpy(&record.type, in + 2, sizeof(record.type));
+        std::memcpy(&record.variant, in + 3, sizeof(record.variant));
+        std::memcpy(&record.x, in + 4, sizeof(record.x));
+        std::memcpy(&record.y, in + 6, sizeof(record.y));
+        std::memcpy(&record.angle, in + 8, sizeof(record.angle));
+        return record;
+    }
+};
+
+// Trailing ENTITY_CREATE data for gun and ammo pickups
+struct PickupInfo {
+    static constexpr size_t SIZE = 4;
+
+    uint8_t itemType;
+    uint8_t ammoType;
+    uint16_t amount;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &itemType, sizeof(itemType));
+        std::memcpy(out + 1, &ammoType, sizeof(ammoType));
+        std::memcpy(out + 2, &amount, sizeof(amount));
+    }
+
+    static PickupInfo decode(const char* in) {
+        PickupInfo record;
+        std::memcpy(&record.itemType, in + 0, sizeof(record.itemType));
+        std::memcpy(&record.ammoType, in + 1, sizeof(record.ammoType));
+        std::memcpy(&record.amount, in + 2, sizeof(record.amount));
+        return record;
+    }
+};
+
+// ENTITY_STATE body
+struct EntityState {
+    static constexpr size_t SIZE = 3;
+
+    uint16_t id;
+    uint8_t state;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &id, sizeof(id));
+        std::memcpy(out + 2, &state, sizeof(state));
+    }
+
+    static EntityState decode(const char* in) {
+        EntityState record;
+        std::memcpy(&record.id, in + 0, sizeof(record.id));
+        std::memcpy(&record.state, in + 2, sizeof(record.state));
+        return record;
+    }
+};
+
+// AMMO_UPDATE body
+struct AmmoUpdate {
+    static constexpr size_t SIZE = 8;
+
+    uint16_t ammoInMag;
+    uint16_t ammoReserve;
+    float reloadRemaining;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &ammoInMag, sizeof(ammoInMag));
+        std::memcpy(out + 2, &ammoReserve, sizeof(ammoReserve));
+        std::memcpy(out + 4, &reloadRemaining, sizeof(reloadRemaining));
+    }
+
+    static AmmoUpdate decode(const char* in) {
+        AmmoUpdate record;
+        std::memcpy(&record.ammoInMag, in + 0, sizeof(record.ammoInMag));
+        std::memcpy(&record.ammoReserve, in + 2, sizeof(record.ammoReserve));
+        std::memcpy(&record.reloadRemaining, in + 4,
+                    sizeof(record.reloadRemaining));
+        return record;
+    }
+};
+
+// BULLET_TRACE body
+struct BulletTrace {
+    static constexpr size_t SIZE = 18;
+
+    uint16_t shooter;
+    float startX;
+    float startY;
+    float endX;
+    float endY;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &shooter, sizeof(shooter));
+        std::memcpy(out + 2, &startX, sizeof(startX));
+        std::memcpy(out + 6, &startY, sizeof(startY));
+        std::memcpy(out + 10, &endX, sizeof(endX));
+        std::memcpy(out + 14, &endY, sizeof(endY));
+    }
+
+    static BulletTrace decode(const char* in) {
+        BulletTrace record;
+        std::memcpy(&record.shooter, in + 0, sizeof(record.shooter));
+        std::memcpy(&record.startX, in + 2, sizeof(record.startX));
+        std::memcpy(&record.startY, in + 6, sizeof(record.startY));
+        std::memcpy(&record.endX, in + 10, sizeof(record.endX));
+        std::memcpy(&record.endY, in + 14, sizeof(record.endY));
+        return record;
+    }
+};
+
+// PROJECTILE_SPAWN_BATCH entry. x/y is the muzzle relative to the batch origin,
+// speed is the weapon's projectileSpeed from GAME_CONFIG and the projectile was
+// fired tickOffset ticks before the batch tick
+struct ProjectileSpawn {
+    static constexpr size_t SIZE = 10;
+
+    uint16_t id;
+    uint8_t weapon;
+    int16_t x;
+    int16_t y;
+    uint16_t angle;
+    uint8_t tickOffset;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &id, sizeof(id));
+        std::memcpy(out + 2, &weapon, sizeof(weapon));
+        std::memcpy(out + 3, &x, sizeof(x));
+        std::memcpy(out + 5, &y, sizeof(y));
+        std::memcpy(out + 7, &angle, sizeof(angle));
+        std::memcpy(out + 9, &tickOffset, sizeof(tickOffset));
+    }
+
+    static ProjectileSpawn decode(const char* in) {
+        ProjectileSpawn record;
+        std::memcpy(&record.id, in + 0, sizeof(record.id));
+        std::memcpy(&record.weapon, in + 2, sizeof(record.weapon));
+        std::memcpy(&record.x, in + 3, sizeof(record.x));
+        std::memcpy(&record.y, in + 5, sizeof(record.y));
+        std::memcpy(&record.angle, in + 7, sizeof(record.angle));
+        std::memcpy(&record.tickOffset, in + 9, sizeof(record.tickOffset));
+        return record;
+    }
+};
+
+// PROJECTILE_SPAWN_BATCH fan entry, one per multi-pellet shot. Pellet i flies
+// at angle + pelletSpread(seed, i), alive has a bit per pellet still in flight
+struct FanSpawn {
+    static constexpr size_t SIZE = 14;
+
+    uint16_t id;
+    uint8_t weapon;
+    int16_t x;
+    int16_t y;
+    uint16_t angle;
+    uint8_t tickOffset;
+    uint16_t seed;
+    uint16_t alive;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &id, sizeof(id));
+        std::memcpy(out + 2, &weapon, sizeof(weapon));
+        std::memcpy(out + 3, &x, sizeof(x));
+        std::memcpy(out + 5, &y, sizeof(y));
+        std::memcpy(out + 7, &angle, sizeof(angle));
+        std::memcpy(out + 9, &tickOffset, sizeof(tickOffset));
+        std::memcpy(out + 10, &seed, sizeof(seed));
+        std::memcpy(out + 12, &alive, sizeof(alive));
+    }
+
+    static FanSpawn decode(const char* in) {
+        FanSpawn record;
+        std::memcpy(&record.id, in + 0, sizeof(record.id));
+        std::memcpy(&record.weapon, in + 2, sizeof(record.weapon));
+        std::memcpy(&record.x, in + 3, sizeof(record.x));
+        std::memcpy(&record.y, in + 5, sizeof(record.y));
+        std::memcpy(&record.angle, in + 7, sizeof(record.angle));
+        std::memcpy(&record.tickOffset, in + 9, sizeof(record.tickOffset));
+        std::memcpy(&record.seed, in + 10, sizeof(record.seed));
+        std::memcpy(&record.alive, in + 12, sizeof(record.alive));
+        return record;
+    }
+};
+
+// PROJECTILE_DESTROY entry for one pellet of a fan
+struct PelletImpact {
+    static constexpr size_t SIZE = 3;
+
+    uint16_t id;
+    uint8_t pellet;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &id, sizeof(id));
+        std::memcpy(out + 2, &pellet, sizeof(pellet));
+    }
+
+    static PelletImpact decode(const char* in) {
+        PelletImpact record;
+        std::memcpy(&record.id, in + 0, sizeof(record.id));
+        std::memcpy(&record.pellet, in + 2, sizeof(record.pellet));
+        return record;
+    }
+};
+
+// NEWS body when the news type is KILL
+struct KillNews {
+    static constexpr size_t SIZE = 4;
+
+    uint16_t subject;
+    uint16_t killer;
+
+    void encode(char* out) const {
+        std::memcpy(out + 0, &subject, sizeof(subject));
+        std::memcpy(out + 2, &killer, sizeof(killer));
+    }
+
+    static KillNews decode(const char* in) {
+        KillNews record;
+        std::memcpy(&record.subject, in + 0, sizeof(record.subject));
+        std::memcpy(&record.killer, in + 2, sizeof(record.killer));
+        return record;
+    }
+};
+
+}  // namespace Protocol
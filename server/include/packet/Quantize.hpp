@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "packet/Protocol.hpp"
+
+// Positions are sent as offsets from the snapshot origin in
+// 1/POSITION_SCALE pixel steps, clamped to the i16 range (+-8192 px at 1/4).
+inline int16_t quantizeOffset(float offsetPixels) {
+    float steps = std::round(offsetPixels * Protocol::POSITION_SCALE);
+    return static_cast<int16_t>(std::clamp(steps, -32768.0f, 32767.0f));
+}
+
+// Absolute world positions for the delta snapshots, same step size.
+inline int32_t quantizePosition(float pixels) {
+    return static_cast<int32_t>(
+        std::lround(pixels * Protocol::POSITION_SCALE));
+}
+
+// Angles are wrapped into one turn and spread over the full u16 range.
+inline uint16_t quantizeAngle(float radians) {
+    constexpr float TWO_PI = 6.28318530718f;
+    float turns = radians / TWO_PI;
+    turns -= std::floor(turns);
+    return static_cast<uint16_t>(std::lround(turns * 65536.0f) & 0xFFFF);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Reads values written by BitWriter, least significant bit first. Like
+// PacketReader, an overflow sets a sticky failed flag and reads return zero.
+class BitReader {
+   public:
+    BitReader() {}
+
+    void loadMessage(const std::string_view& message);
+
+    uint32_t readBits(unsigned int bits);
+    bool readBool();
+    uint32_t readVarU32();
+    int32_t readVarS32();
+    void alignToByte();
+
+    // byte offset, rounded up when mid-byte
+    size_t getOffset();
+    size_t byteLength();
+    bool failed() const { return m_failed; }
+
+   private:
+    std::string_view m_message;
+    size_t m_bitOffset = 0;
+    bool m_failed = false;
+
+    bool validateBounds(unsigned int bits);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Packs values into a byte buffer at bit granularity, least significant bit
+// first. Use it for message bodies made of small counts, enums and flags
+// that would waste most of a byte (or four) with PacketWriter.
+class BitWriter {
+   public:
+    BitWriter() {}
+
+    // write the low `bits` bits of value, bits <= 32
+    void writeBits(uint32_t value, unsigned int bits);
+    void writeBool(bool value);
+    // LEB128 style: 7 bits per group plus a continuation bit
+    void writeVarU32(uint32_t value);
+    // zig-zag encoded so small negative deltas stay small
+    void writeVarS32(int32_t value);
+    // pad with zero bits up to the next byte boundary
+    void alignToByte();
+
+    // pads the final byte, so only call once the message is complete
+    std::string_view getMessage();
+    void clear();
+    bool hasData();
+    size_t bitLength();
+
+   private:
+    std::string m_message;
+    uint64_t m_scratch = 0;
+    unsigned int m_scratchBits = 0;
+};
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
 #include <string_view>
 
+// Reads little-endian primitives from a message. A read past the end marks
+// the reader as failed and returns zero (or an empty string); every read
+// after that fails too, so callers only check failed() once per message.
 class PacketReader {
    public:
     PacketReader() {}
@@ -20,10 +24,12 @@ class PacketReader {
 
     size_t getOffset();
     size_t byteLength();
+    bool failed() const { return m_failed; }
 
    private:
     std::string_view m_message;
-    size_t m_offset;
+    size_t m_offset = 0;
+    bool m_failed = false;
 
-    void validateBounds(unsigned int size);
+    bool validateBounds(size_t length);
 };
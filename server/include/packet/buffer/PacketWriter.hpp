@@ -1,15 +1,23 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
 
+// Immutable, ref-counted serialized bytes that can be queued on many clients
+using SharedBuffer = std::shared_ptr<const std::string>;
+
+// Appends little-endian primitives to a reusable buffer. m_offset is the
+// write cursor; the buffer only grows (doubling) and clear() keeps it, so a
+// writer that is reused every tick stops allocating once it is warm.
 class PacketWriter {
    public:
     PacketWriter() {}
+    explicit PacketWriter(size_t capacity) { reserve(capacity); }
 
     std::string m_message;
-    size_t m_offset;
+    size_t m_offset = 0;
 
     void writeU8(uint8_t x);
     void writeU16(uint16_t x);
@@ -20,7 +28,26 @@ class PacketWriter {
     template <class T>
     void writeBytes(T data);
 
+    // Append a fixed-size record from packet/Protocol.hpp with one resize;
+    // the record copies its fields straight into the buffer.
+    template <class Record>
+    void writeRecord(const Record& record) {
+        record.encode(claim(Record::SIZE));
+    }
+    // copy a pre-serialized block in with a single memcpy
+    void appendRaw(std::string_view bytes);
+    // make room for `bytes` more without reallocating while writing
+    void reserve(size_t bytes);
+
     std::string_view getMessage();
     void clear();
     bool hasData();
+    // exchange buffers without copying, used to double buffer outbound frames
+    void swap(PacketWriter& other);
+    // move the written bytes into a shared buffer and leave the writer empty
+    SharedBuffer share();
+
+   private:
+    // grow if needed and return where the next `bytes` bytes go
+    char* claim(size_t bytes);
 };
@@ -2,6 +2,9 @@
 
 #include <box2d/box2d.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace AABBCollision {
 
 inline bool pointInAABB(const b2Vec2& point, const b2AABB& aabb) {
@@ -16,4 +19,32 @@ inline bool circleAABBOverlap(const b2Vec2& circleCenter, float radius,
            aabb.lowerBound.y <= circleCenter.y + radius &&
            aabb.upperBound.y >= circleCenter.y - radius;
 }
+
+// Slab test, true if any part of the segment from a to b is inside the box
+inline bool segmentInAABB(const b2Vec2& a, const b2Vec2& b,
+                          const b2AABB& aabb) {
+    const float start[2] = {a.x, a.y};
+    const float delta[2] = {b.x - a.x, b.y - a.y};
+    const float lower[2] = {aabb.lowerBound.x, aabb.lowerBound.y};
+    const float upper[2] = {aabb.upperBound.x, aabb.upperBound.y};
+
+    float tMin = 0.0f;
+    float tMax = 1.0f;
+    for (int axis = 0; axis < 2; ++axis) {
+        if (std::abs(delta[axis]) < 1e-6f) {
+            if (start[axis] < lower[axis] || start[axis] > upper[axis]) {
+                return false;
+            }
+            continue;
+        }
+
+        float t0 = (lower[axis] - start[axis]) / delta[axis];
+        float t1 = (upper[axis] - start[axis]) / delta[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax) return false;
+    }
+    return true;
+}
 }  // namespace AABBCollision
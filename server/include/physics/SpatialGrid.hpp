@@ -0,0 +1,111 @@
+#pragma once
+
+#include <box2d/math_functions.h>
+
+#include <cmath>
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Maps world positions (meters) to hashed cell keys
+struct GridCells {
+    explicit GridCells(float cellSize) : inverseCellSize(1.0f / cellSize) {}
+
+    int32_t coord(float value) const {
+        return static_cast<int32_t>(std::floor(value * inverseCellSize));
+    }
+
+    static uint64_t key(int32_t x, int32_t y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+               static_cast<uint32_t>(y);
+    }
+
+    uint64_t keyAt(b2Vec2 position) const {
+        return key(coord(position.x), coord(position.y));
+    }
+
+    // fn(key) for every cell the box overlaps
+    template <class Fn>
+    void forEachCell(const b2AABB& aabb, Fn&& fn) const {
+        const int32_t minX = coord(aabb.lowerBound.x);
+        const int32_t minY = coord(aabb.lowerBound.y);
+        const int32_t maxX = coord(aabb.upperBound.x);
+        const int32_t maxY = coord(aabb.upperBound.y);
+
+        for (int32_t x = minX; x <= maxX; ++x) {
+            for (int32_t y = minY; y <= maxY; ++y) fn(key(x, y));
+        }
+    }
+
+    float inverseCellSize;
+};
+
+// Uniform grid of networked entities hashed by cell, so a visibility query
+// only touches the cells a camera overlaps instead of every entity. An entity
+// is only re-bucketed when it crosses into another cell.
+class SpatialGrid {
+   public:
+    explicit SpatialGrid(float cellSize);  // meters
+
+    // inserts the entity, or moves it if it crossed into another cell
+    void update(entt::entity entity, b2Vec2 position);
+    void remove(entt::entity entity);
+
+    // fn(entity) for everything in the cells the box overlaps, callers still
+    // test the exact position
+    template <class Fn>
+    void query(const b2AABB& aabb, Fn&& fn) const;
+
+   private:
+    struct Location {
+        uint64_t cell = 0;
+        uint32_t slot = 0;
+        bool placed = false;
+    };
+
+    GridCells m_grid;
+    std::unordered_map<uint64_t, std::vector<entt::entity>> m_cells;
+    // indexed by entity index, lets a move swap-remove in O(1)
+    std::vector<Location> m_locations;
+};
+
+template <class Fn>
+void SpatialGrid::query(const b2AABB& aabb, Fn&& fn) const {
+    m_grid.forEachCell(aabb, [&](uint64_t key) {
+        auto it = m_cells.find(key);
+        if (it == m_cells.end()) return;
+        for (entt::entity entity : it->second) fn(entity);
+    });
+}
+
+// Items filed under every cell their bounds overlap. Rebuilt each tick for
+// things that move too far per tick to be worth tracking incrementally.
+class CellBuckets {
+   public:
+    explicit CellBuckets(float cellSize) : m_grid(cellSize) {}
+
+    // empties every bucket but keeps the memory
+    void clear();
+    void insert(uint32_t item, const b2AABB& bounds);
+
+    // fn(item) for everything in the cells the box overlaps, an item that
+    // spans several of them is reported once per cell
+    template <class Fn>
+    void query(const b2AABB& aabb, Fn&& fn) const;
+
+   private:
+    GridCells m_grid;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_buckets;
+    // keys filled since the last clear
+    std::vector<uint64_t> m_used;
+};
+
+template <class Fn>
+void CellBuckets::query(const b2AABB& aabb, Fn&& fn) const {
+    m_grid.forEachCell(aabb, [&](uint64_t key) {
+        auto it = m_buckets.find(key);
+        if (it == m_buckets.end()) return;
+        for (uint32_t item : it->second) fn(item);
+    });
+}
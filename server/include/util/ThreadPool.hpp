@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork-join work inside a tick. The calling
+// thread takes part as worker 0, so a pool of one runs everything inline.
+class ThreadPool {
+   public:
+    using Job = std::function<void(size_t index, size_t worker)>;
+
+    // threads counts the caller, 0 picks one per hardware thread
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return m_workers.size() + 1; }
+
+    // Runs job(index, worker) for every index in [0, count) and returns once
+    // all of them finished. worker is below size(), so callers can keep
+    // per-worker scratch state.
+    void parallelFor(size_t count, const Job& job);
+
+   private:
+    void workerLoop(size_t worker);
+    void runJobs(size_t worker);
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    // published under m_mutex along with m_claims
+    const Job* m_job = nullptr;
+    size_t m_count = 0;
+    size_t m_claims = 0;  // worker wakeups still to be taken for this job
+    size_t m_busy = 0;    // claims that have not finished the current job
+    bool m_stopping = false;
+
+    std::atomic<size_t> m_next{0};
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Spread offset in radians for one pellet of a seeded fan. Each pellet hashes
+// (seed, index) on its own so clients can derive any pellet directly. Mirrored
+// in client/src/utils/spread.ts, which rounds to float so the offset matches
+// exactly; adding it to the aim angle is done in each side's own precision.
+inline float pelletSpread(uint16_t seed, int pellet, float spread) {
+    uint32_t x = static_cast<uint32_t>(seed) * 0x9E3779B1u +
+                 static_cast<uint32_t>(pellet + 1) * 0x85EBCA77u;
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+
+    // 24 bits convert to float exactly, so both sides get the same fraction
+    float random01 = static_cast<float>(x >> 8) / 16777216.0f;
+    return (random01 * 2.0f - 1.0f) * spread;
+}
@@ -3,6 +3,7 @@
 #include <box2d/box2d.h>
 #include <box2d/math_functions.h>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cmath>
@@ -11,6 +12,7 @@
 #include <entt/entity/fwd.hpp>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <limits>
 #include <random>
 #include <stdexcept>
 #include <thread>
@@ -23,6 +25,7 @@
 #include "ecs/EntityManager.hpp"
 #include "ecs/GunFactory.hpp"
 #include "ecs/components.hpp"
+#include "packet/Quantize.hpp"
 #include "physics/CollisionHelpers.hpp"
 #include "physics/PhysicsWorld.hpp"
 #include "util/units.hpp"
@@ -30,6 +33,20 @@
 GameServer::GameServer() : m_entityManager(*this), m_physicsWorld(*this) {
     std::cout << "Initializing GameServer..." << std::endl;
 
+    entt::registry& reg = m_entityManager.getRegistry();
+    reg.on_construct<Components::Networked>()
+        .connect<&GameServer::onNetworkedCreated>(*this);
+    reg.on_destroy<Components::Networked>()
+        .connect<&GameServer::onNetworkedDestroyed>(*this);
+
+    // clients are serialized on several threads, which must never have to
+    // insert a component pool, so every pool they read is created up front
+    (void)reg.view<Components::EntityBase, Components::Networked,
+                   Components::Projectile, Components::PelletFan,
+                   Components::State, Components::Camera,
+                   Components::GroundItem, Components::Health,
+                   Components::Inventory, Components::Ammo>();
+
     // Load gameplay configuration (guns, etc.)
     m_gameConfig = GameConfig::loadFromFile("../game_config.json");
 
@@ -73,12 +90,19 @@ GameServer::GameServer() : m_entityManager(*this), m_physicsWorld(*this) {
     m_entityManager.initProjectilePool(256);
     spawnInitialPickups();
 
+    buildJoinBuffers();
+
     std::cout << "GameServer initialization complete!" << std::endl;
 }
 
 void GameServer::run() {
     std::cout << "starting game server!" << std::endl;
 
+    m_serializePool = std::make_unique<ThreadPool>(m_serializeThreads);
+    m_gameStateScratch.resize(m_serializePool->size());
+    std::cout << "serializing snapshots on " << m_serializePool->size()
+              << " threads" << std::endl;
+
     const std::chrono::duration<double> tickInterval(1.0 / m_tps);
 
     auto lastTime = std::chrono::steady_clock::now();
@@ -89,7 +113,7 @@ void GameServer::run() {
         lastTime = currentTime;
 
         // socket server is ready
-        if (m_socketLoop) {
+        if (socketsReady()) {
             std::lock_guard<std::mutex> lock(m_gameMutex);
             tick(deltaTime.count());
 
@@ -110,26 +134,97 @@ void GameServer::run() {
     }
 }
 
-void GameServer::processClientMessages() {
-    for (auto& message : m_messages) {
-        uint32_t id = message.first;
-        std::string_view data = message.second;
+// Everything a joining client receives that is identical for all clients is
+// serialized here once. Terrain uses a compact vertex encoding when the world
+// fits in 16-bit grid coordinates; otherwise it falls back to floats.
+void GameServer::buildJoinBuffers() {
+    PacketWriter writer;
 
-        auto it = m_clients.find(id);
-        if (it != m_clients.end()) {
-            Client* client = it->second;
-            try {  // TODO: I dont really like try-catch. Maybe lets just not
-                   // read outside buffer and set outside bytes to zero
-                client->onMessage(data);
-            } catch (std::runtime_error error) {
-                // Reading outside buffer view..
+    // first so a stale client can tell it cannot decode what follows
+    writer.writeU8(ServerHeader::PROTOCOL);
+    writer.writeU16(Protocol::VERSION);
+
+    writer.writeU8(ServerHeader::TPS);
+    writer.writeU8(m_tps);
+
+    writer.writeU8(ServerHeader::MAP_INIT);
+    writer.writeU32(static_cast<uint32_t>(m_worldGenerator->GetWorldSize()));
+
+    writer.writeU8(ServerHeader::GAME_CONFIG);
+    writer.writeString(m_gameConfig.toJsonString());
+
+    m_handshakeBuffer = writer.share();
+
+    const uint32_t worldSize = m_worldGenerator->GetWorldSize();
+    const bool useU16 = worldSize <= std::numeric_limits<uint16_t>::max();
+
+    for (size_t biomeIdx = 0; biomeIdx < m_terrainMeshes.size(); ++biomeIdx) {
+        const TerrainMesh& mesh = m_terrainMeshes[biomeIdx];
+
+        writer.writeU8(ServerHeader::BIOME_CREATE);
+        writer.writeU32(static_cast<uint32_t>(biomeIdx));
+        writer.writeU8(static_cast<uint8_t>(mesh.biome));
+
+        // Encoding flag: 0 = float world pixels, 1 = uint16 heightmap units
+        writer.writeU8(useU16 ? 1 : 0);
+
+        // Write vertices
+        writer.writeU32(static_cast<uint32_t>(mesh.vertices.size()));
+        if (useU16) {
+            for (const Vec2& v : mesh.vertices) {
+                // Clamp to u16 bounds just in case
+                uint16_t vx = static_cast<uint16_t>(
+                    std::clamp(v.x, 0.0f, static_cast<float>(worldSize)));
+                uint16_t vy = static_cast<uint16_t>(
+                    std::clamp(v.y, 0.0f, static_cast<float>(worldSize)));
+                writer.writeU16(vx);
+                writer.writeU16(vy);
             }
         } else {
-            std::cout << "Client with ID " << id << " not found" << std::endl;
+            for (const Vec2& v : mesh.vertices) {
+                writer.writeFloat(v.x * 64.0f);
+                writer.writeFloat(v.y * 64.0f);
+            }
+        }
+
+        // Write indices
+        writer.writeU32(static_cast<uint32_t>(mesh.indices.size()));
+        for (uint32_t idx : mesh.indices) {
+            writer.writeU32(idx);
+        }
+    }
+
+    m_terrainBuffer = writer.share();
+
+    std::cout << "Join buffers: handshake " << m_handshakeBuffer->size()
+              << " bytes, terrain " << m_terrainBuffer->size() << " bytes"
+              << std::endl;
+}
+
+bool GameServer::socketsReady() const {
+    return std::any_of(m_socketLoops.begin(), m_socketLoops.end(),
+                       [](const SocketLoop* loop) { return loop->isReady(); });
+}
+
+void GameServer::processClientMessages() {
+    // Client ids are never reused, so frames still queued from a client that
+    // has since disconnected simply fail the lookup and are skipped.
+    auto handleMessage = [this](uint32_t id, std::string_view data) {
+        auto it = m_clients.find(id);
+        if (it != m_clients.end()) {
+            it->second->onMessage(data);
         }
+    };
+
+    // a client lives on exactly one loop, so its frames stay in order
+    for (SocketLoop* loop : m_socketLoops) {
+        loop->m_messages.drain(handleMessage);
     }
 
-    m_messages.clear();
+    // after spawns so a new player picks up the inputs already held down
+    for (auto& [id, client] : m_clients) {
+        client->applyInput();
+    }
 }
 
 void GameServer::tick(double delta) {
@@ -150,22 +245,30 @@ void GameServer::tick(double delta) {
         m_entityManager.removeEntities();
     }
 
-    flushProjectileSpawnBatch();
+    flushProjectileSpawnBatch(delta);
     flushProjectileDestroyBatch();
+    flushBroadcasts();
 
     {  // server update
-        for (auto& c : m_clients) {
-            Client& client = *c.second;
-            client.writeGameState();
+        // every client only writes its own buffers, the world is read-only
+        // until the next tick
+        m_serializeClients.clear();
+        for (auto& c : m_clients) m_serializeClients.push_back(c.second);
+
+        m_serializePool->parallelFor(
+            m_serializeClients.size(), [this](size_t index, size_t worker) {
+                Client& client = *m_serializeClients[index];
+                client.writeGameState(m_gameStateScratch[worker]);
+                client.publish();
+            });
+
+        for (Client* client : m_serializeClients) client->updateObservers();
+
+        // each socket thread sends its clients' published frames without the
+        // game mutex
+        for (SocketLoop* loop : m_socketLoops) {
+            loop->deferFlush();
         }
-
-        m_socketLoop->defer([this]() {
-            std::lock_guard<std::mutex> lock(m_gameMutex);
-            for (auto& c : m_clients) {
-                Client& client = *c.second;
-                client.sendBytes();
-            }
-        });
     }
 }
 
@@ -175,6 +278,7 @@ void GameServer::prePhysicsSystemUpdate(double delta) {
     inputSystem(delta);
     gunSystem(delta);
     projectileSystem(delta);
+    pelletFanSystem(delta);
     meleeSystem(delta);
     healthSystem(delta);
     cameraSystem();
@@ -183,6 +287,7 @@ void GameServer::prePhysicsSystemUpdate(double delta) {
 void GameServer::postPhysicsSystemUpdate(double /*delta*/) {
     projectileImpactSystem();
     pickupSystem();
+    spatialGridSystem();
 }
 
 void GameServer::spawnInitialPickups() {
@@ -458,6 +563,17 @@ void GameServer::gunSystem(double delta) {
             b2Vec2 position = b2Body_GetPosition(base.bodyId);
             const float playerRadiusMeters = meters(25.0f);
 
+            if (gun.fireMode == GunFireMode::FIRE_PROJECTILE &&
+                gun.pellets > 1) {
+                float muzzleOffset = playerRadiusMeters + gun.barrelLength;
+                b2Vec2 muzzle = {
+                    position.x + std::cos(input.angle) * muzzleOffset,
+                    position.y + std::sin(input.angle) * muzzleOffset};
+                m_entityManager.createPelletFan(entity, gun, m_currentTick,
+                                                muzzle, input.angle);
+                return;
+            }
+
             for (int pellet = 0; pellet < gun.pellets; ++pellet) {
                 float random01 = static_cast<float>(rand()) / RAND_MAX;
                 float spread = (random01 * 2.0f - 1.0f) * gun.spread;
@@ -479,7 +595,7 @@ void GameServer::gunSystem(double delta) {
                                       muzzleOrigin.x + direction.x * gun.range,
                                       muzzleOrigin.y + direction.y * gun.range};
 
-                    broadcastBulletTrace(entity, muzzleOrigin, endPoint);
+                    queueBulletTrace(entity, muzzleOrigin, endPoint);
 
                     if (hit.hit && hit.entity != entt::null) {
                         applyDamage(entity, hit.entity, gun.damage);
@@ -523,21 +639,85 @@ void GameServer::gunSystem(double delta) {
 void GameServer::projectileSystem(double delta) {
     entt::registry& reg = m_entityManager.getRegistry();
 
-    reg.view<Components::Projectile, Components::EntityBase>().each(
-        [&](entt::entity entity, Components::Projectile& proj,
-            Components::EntityBase& base) {
+    reg.view<Components::ActiveProjectile, Components::Projectile,
+             Components::EntityBase>()
+        .each([&](entt::entity entity, Components::Projectile& proj,
+                  Components::EntityBase& base) {
             if (!proj.active) return;
             if (B2_IS_NULL(base.bodyId)) return;
 
+            // clients expire projectiles on their own from the weapon's
+            // lifetime, only impacts are sent
             proj.remainingLife -= static_cast<float>(delta);
             if (proj.remainingLife <= 0.0f) {
-                m_projectileDestroyQueue.push_back(
-                    static_cast<uint32_t>(entity));
+                forgetProjectile(entity, proj.netId);
                 m_entityManager.releaseProjectile(entity);
             }
         });
 }
 
+template <class Fn>
+void GameServer::forEachObserver(entt::entity entity, Fn&& fn) {
+    entt::registry& reg = m_entityManager.getRegistry();
+    auto* observers = reg.try_get<Components::Observers>(entity);
+    if (!observers) return;
+
+    for (uint32_t id : observers->clients) {
+        auto it = m_clients.find(id);
+        if (it != m_clients.end()) fn(*it->second);
+    }
+}
+
+void GameServer::forgetProjectile(entt::entity entity, uint16_t netId) {
+    forEachObserver(entity, [&](Client& client) {
+        client.m_visibleProjectiles.erase(netId);
+    });
+}
+
+void GameServer::pelletFanSystem(double delta) {
+    entt::registry& reg = m_entityManager.getRegistry();
+
+    reg.view<Components::PelletFan>().each(
+        [&](entt::entity entity, Components::PelletFan& fan) {
+            const float step = fan.speed * static_cast<float>(delta);
+
+            for (int pellet = 0; pellet < fan.pellets; ++pellet) {
+                if (!(fan.alive & (1u << pellet))) continue;
+
+                b2Vec2 head = fan.head(pellet);
+                glm::vec2 start = {head.x, head.y};
+                glm::vec2 direction = {fan.directions[pellet].x,
+                                       fan.directions[pellet].y};
+
+                RayHit hit = m_raycastSystem->FireBullet(fan.owner, start,
+                                                         direction, step);
+                if (!hit.hit) continue;
+
+                if (hit.entity != entt::null && reg.valid(hit.entity)) {
+                    applyDamage(fan.owner, hit.entity, fan.damage);
+                }
+                fan.alive &= ~(1u << pellet);
+
+                // the fan stays visible while its other pellets fly
+                const Protocol::PelletImpact impact{
+                    fan.netId, static_cast<uint8_t>(pellet)};
+                forEachObserver(entity, [&](Client& client) {
+                    client.m_pelletImpacts.push_back(impact);
+                });
+            }
+
+            fan.travelled += step;
+            fan.remainingLife -= static_cast<float>(delta);
+
+            // like projectiles, clients expire the rest of the fan on their
+            // own
+            if (fan.alive == 0 || fan.remainingLife <= 0.0f) {
+                forgetProjectile(entity, fan.netId);
+                m_entityManager.scheduleForRemoval(entity);
+            }
+        });
+}
+
 void GameServer::projectileImpactSystem() {
     entt::registry& reg = m_entityManager.getRegistry();
 
@@ -579,12 +759,52 @@ void GameServer::projectileImpactSystem() {
         if (targetEntity != entt::null && reg.valid(targetEntity)) {
             applyDamage(projectile.owner, targetEntity, projectile.damage);
         }
-        m_projectileDestroyQueue.push_back(
-            static_cast<uint32_t>(projectileEntity));
+        const uint16_t netId = projectile.netId;
+        forEachObserver(projectileEntity, [&](Client& client) {
+            client.m_visibleProjectiles.erase(netId);
+            client.m_projectileDestroys.push_back(netId);
+        });
         m_entityManager.releaseProjectile(projectileEntity);
     }
 }
 
+void GameServer::onNetworkedCreated(entt::registry& /*reg*/,
+                                    entt::entity entity) {
+    m_gridPending.push_back(entity);
+}
+
+void GameServer::onNetworkedDestroyed(entt::registry& /*reg*/,
+                                      entt::entity entity) {
+    m_spatialGrid.remove(entity);
+}
+
+void GameServer::spatialGridSystem() {
+    entt::registry& reg = m_entityManager.getRegistry();
+
+    for (entt::entity entity : m_gridPending) {
+        if (!reg.valid(entity)) continue;
+        auto* base = reg.try_get<Components::EntityBase>(entity);
+        if (!base || B2_IS_NULL(base->bodyId)) continue;
+        m_spatialGrid.update(entity, b2Body_GetPosition(base->bodyId));
+    }
+    m_gridPending.clear();
+
+    // only bodies that moved during the step report an event
+    b2BodyEvents events = b2World_GetBodyEvents(m_physicsWorld.m_worldId);
+
+    for (int i = 0; i < events.moveCount; ++i) {
+        const b2BodyMoveEvent& evt = events.moveEvents[i];
+        if (!evt.userData) continue;
+
+        entt::entity entity =
+            reinterpret_cast<EntityBodyUserData*>(evt.userData)->entity;
+        if (!reg.valid(entity) || !reg.all_of<Components::Networked>(entity))
+            continue;
+
+        m_spatialGrid.update(entity, evt.transform.p);
+    }
+}
+
 namespace {
 
 entt::entity extractPickupEntity(b2ShapeId shapeId) {
@@ -768,15 +988,78 @@ void GameServer::processPickupActions() {
     }
 }
 
-void GameServer::flushProjectileSpawnBatch() {
+void GameServer::indexProjectileFlights(double delta) {
     entt::registry& reg = m_entityManager.getRegistry();
-    auto projectileView =
-        reg.view<Components::Projectile, Components::EntityBase>();
+    // what the simulation actually advanced by, a slow tick covers more
+    const float tickSeconds = static_cast<float>(delta);
+
+    m_projectileFlights.clear();
+    m_projectileCells.clear();
+
+    // the segment covered since the last tick, so a fast projectile that
+    // crossed a view between two ticks is still seen
+    reg.view<Components::ActiveProjectile, Components::Projectile,
+             Components::EntityBase>()
+        .each([&](entt::entity entity, Components::Projectile& projectile,
+                  Components::EntityBase& base) {
+            if (!projectile.active) return;
+            if (B2_IS_NULL(base.bodyId)) return;
+            // without an id the client could never be told it is gone
+            if (projectile.netId == NetIdAllocator::NULL_ID) return;
+
+            b2Vec2 to = b2Body_GetPosition(base.bodyId);
+            b2Vec2 velocity = b2Body_GetLinearVelocity(base.bodyId);
+            b2Vec2 from = {to.x - velocity.x * tickSeconds,
+                           to.y - velocity.y * tickSeconds};
+            m_projectileFlights.push_back({ProjectileFlight::PROJECTILE,
+                                           projectile.netId, entity, 0, from,
+                                           to});
+        });
+
+    reg.view<Components::PelletFan>().each(
+        [&](entt::entity entity, Components::PelletFan& fan) {
+            if (fan.netId == NetIdAllocator::NULL_ID) return;
+
+            const float step = fan.speed * tickSeconds;
+            for (int pellet = 0; pellet < fan.pellets; ++pellet) {
+                if (!(fan.alive & (1u << pellet))) continue;
+
+                float behind = std::min(step, fan.travelled);
+                b2Vec2 to = fan.head(pellet);
+                b2Vec2 from = {to.x - fan.directions[pellet].x * behind,
+                               to.y - fan.directions[pellet].y * behind};
+                m_projectileFlights.push_back(
+                    {ProjectileFlight::FAN, fan.netId, entity, 0, from, to});
+            }
+        });
+
+    for (uint32_t i = 0; i < m_bulletTraces.size(); ++i) {
+        const QueuedTrace& trace = m_bulletTraces[i];
+        m_projectileFlights.push_back({ProjectileFlight::TRACE,
+                                       NetIdAllocator::NULL_ID, entt::null, i,
+                                       trace.from, trace.to});
+    }
+
+    for (uint32_t i = 0; i < m_projectileFlights.size(); ++i) {
+        const ProjectileFlight& flight = m_projectileFlights[i];
+        b2AABB bounds;
+        bounds.lowerBound = b2Min(flight.from, flight.to);
+        bounds.upperBound = b2Max(flight.from, flight.to);
+        m_projectileCells.insert(i, bounds);
+    }
+}
 
-    if (projectileView.begin() == projectileView.end()) {
+// Projectile and fan spawns, plus the hitscan traces queued this tick
+void GameServer::flushProjectileSpawnBatch(double delta) {
+    indexProjectileFlights(delta);
+    if (m_projectileFlights.empty()) {
         return;
     }
 
+    entt::registry& reg = m_entityManager.getRegistry();
+    std::vector<Protocol::ProjectileSpawn> newlyVisible;
+    std::vector<Protocol::FanSpawn> newFans;
+
     for (auto& [id, client] : m_clients) {
         if (!reg.valid(client->m_entity) ||
             !reg.all_of<Components::Camera>(client->m_entity)) {
@@ -797,79 +1080,109 @@ void GameServer::flushProjectileSpawnBatch() {
         queryAABB.lowerBound = {camPos.x - halfViewX, camPos.y - halfViewY};
         queryAABB.upperBound = {camPos.x + halfViewX, camPos.y + halfViewY};
 
-        struct SpawnPayload {
-            uint32_t id;
-            float originX;
-            float originY;
-            float dirX;
-            float dirY;
-            float speed;
-            uint64_t spawnTick;
-        };
-
-        std::vector<SpawnPayload> newlyVisible;
-
-        for (auto entity : projectileView) {
-            auto& projectile =
-                projectileView.get<Components::Projectile>(entity);
-            auto& base = projectileView.get<Components::EntityBase>(entity);
-
-            if (!projectile.active) continue;
-            if (B2_IS_NULL(base.bodyId)) continue;
-            if (!b2Body_IsEnabled(base.bodyId)) continue;
-
-            const b2Vec2& pos = b2Body_GetPosition(base.bodyId);
-            if (!AABBCollision::pointInAABB(pos, queryAABB)) {
-                continue;
+        // muzzle positions are sent relative to the camera centre
+        const Protocol::SnapshotOrigin origin{pixels(camPos.x),
+                                              pixels(camPos.y)};
+        newlyVisible.clear();
+        newFans.clear();
+
+        m_projectileCells.query(queryAABB, [&](uint32_t index) {
+            const ProjectileFlight& flight = m_projectileFlights[index];
+
+            if (flight.kind == ProjectileFlight::TRACE) {
+                QueuedTrace& trace = m_bulletTraces[flight.trace];
+                if (trace.sentTo == client->m_id) return;
+                if (!AABBCollision::segmentInAABB(trace.from, trace.to,
+                                                  queryAABB)) {
+                    return;
+                }
+                trace.sentTo = client->m_id;
+                client->m_writer.writeU8(ServerHeader::BULLET_TRACE);
+                client->m_writer.writeRecord(trace.record);
+                return;
             }
 
-            uint32_t projectileId = static_cast<uint32_t>(entity);
-            if (client->m_visibleProjectiles.insert(projectileId).second) {
-                newlyVisible.push_back({projectileId, projectile.originX,
-                                        projectile.originY, projectile.dirX,
-                                        projectile.dirY, projectile.speed,
-                                        projectile.spawnTick});
+            if (client->m_visibleProjectiles.contains(flight.netId)) return;
+            if (!AABBCollision::segmentInAABB(flight.from, flight.to,
+                                              queryAABB)) {
+                return;
+            }
+            if (!client->m_visibleProjectiles.insert(flight.netId)) return;
+            reg.get_or_emplace<Components::Observers>(flight.entity)
+                .add(client->m_id);
+
+            if (flight.kind == ProjectileFlight::FAN) {
+                auto& fan = reg.get<Components::PelletFan>(flight.entity);
+                uint64_t age = m_currentTick - fan.spawnTick;
+                newFans.push_back(
+                    {fan.netId, static_cast<uint8_t>(fan.weapon),
+                     quantizeOffset(pixels(fan.origin.x) - origin.x),
+                     quantizeOffset(pixels(fan.origin.y) - origin.y),
+                     quantizeAngle(fan.angle),
+                     static_cast<uint8_t>(std::min<uint64_t>(age, 255)),
+                     fan.seed, fan.alive});
+                return;
             }
-        }
 
-        if (newlyVisible.empty()) {
+            auto& projectile = reg.get<Components::Projectile>(flight.entity);
+            uint64_t age = m_currentTick - projectile.spawnTick;
+            newlyVisible.push_back(
+                {projectile.netId, static_cast<uint8_t>(projectile.weapon),
+                 quantizeOffset(projectile.originX - origin.x),
+                 quantizeOffset(projectile.originY - origin.y),
+                 quantizeAngle(std::atan2(projectile.dirY, projectile.dirX)),
+                 static_cast<uint8_t>(std::min<uint64_t>(age, 255))});
+        });
+
+        if (newlyVisible.empty() && newFans.empty()) {
             continue;
         }
 
+        client->m_writer.reserve(
+            15 + Protocol::SnapshotOrigin::SIZE +
+            newlyVisible.size() * Protocol::ProjectileSpawn::SIZE +
+            newFans.size() * Protocol::FanSpawn::SIZE);
         client->m_writer.writeU8(ServerHeader::PROJECTILE_SPAWN_BATCH);
         client->m_writer.writeU64(m_currentTick);
+        client->m_writer.writeRecord(origin);
         client->m_writer.writeU32(static_cast<uint32_t>(newlyVisible.size()));
 
-        for (const auto& spawn : newlyVisible) {
-            client->m_writer.writeU32(spawn.id);
-            client->m_writer.writeFloat(spawn.originX);
-            client->m_writer.writeFloat(spawn.originY);
-            client->m_writer.writeFloat(spawn.dirX);
-            client->m_writer.writeFloat(spawn.dirY);
-            client->m_writer.writeFloat(spawn.speed);
-            client->m_writer.writeU64(spawn.spawnTick);
+        for (const Protocol::ProjectileSpawn& spawn : newlyVisible) {
+            client->m_writer.writeRecord(spawn);
+        }
+
+        client->m_writer.writeU16(static_cast<uint16_t>(newFans.size()));
+        for (const Protocol::FanSpawn& spawn : newFans) {
+            client->m_writer.writeRecord(spawn);
         }
     }
+
+    m_bulletTraces.clear();
 }
 
 void GameServer::flushProjectileDestroyBatch() {
-    if (m_projectileDestroyQueue.empty()) {
-        return;
-    }
-
+    // impacts were queued on the clients that had seen the spawn, natural
+    // expiry is implicit
     for (auto& [id, client] : m_clients) {
-        for (uint32_t projectileId : m_projectileDestroyQueue) {
-            auto it = client->m_visibleProjectiles.find(projectileId);
-            if (it == client->m_visibleProjectiles.end()) {
-                continue;
-            }
-            client->m_visibleProjectiles.erase(it);
-            client->m_writer.writeU8(ServerHeader::PROJECTILE_DESTROY);
-            client->m_writer.writeU32(projectileId);
+        std::vector<uint16_t>& destroys = client->m_projectileDestroys;
+        std::vector<Protocol::PelletImpact>& pellets = client->m_pelletImpacts;
+        if (destroys.empty() && pellets.empty()) continue;
+
+        client->m_writer.reserve(5 + destroys.size() * 2 +
+                                 pellets.size() * Protocol::PelletImpact::SIZE);
+        client->m_writer.writeU8(ServerHeader::PROJECTILE_DESTROY);
+        client->m_writer.writeU16(static_cast<uint16_t>(destroys.size()));
+        for (uint16_t projectileId : destroys) {
+            client->m_writer.writeU16(projectileId);
+        }
+        client->m_writer.writeU16(static_cast<uint16_t>(pellets.size()));
+        for (const Protocol::PelletImpact& impact : pellets) {
+            client->m_writer.writeRecord(impact);
         }
-    }
 
-    m_projectileDestroyQueue.clear();
+        destroys.clear();
+        pellets.clear();
+    }
 }
 
 void GameServer::cameraSystem() {
@@ -1022,43 +1335,44 @@ void GameServer::Die(entt::entity entity) {
     }
 }
 
+// Hand this tick's broadcast events to every client as one shared buffer,
+// so the cost of a kill feed does not depend on the player count
+void GameServer::flushBroadcasts() {
+    if (!m_broadcastWriter.hasData()) return;
+
+    SharedBuffer events = m_broadcastWriter.share();
+    for (auto& [id, client] : m_clients) {
+        client->queueSharedBuffer(events);
+    }
+}
+
 void GameServer::broadcastKill(entt::entity subject) {
     entt::registry& reg = m_entityManager.getRegistry();
     entt::entity killer = reg.get<Components::Health>(subject).attacker;
 
-    for (auto& [id, client] : m_clients) {
-        client->m_writer.writeU8(ServerHeader::NEWS);
-        client->m_writer.writeU8(NewsType::KILL);
-        client->m_writer.writeU32(static_cast<uint32_t>(subject));
-        client->m_writer.writeU32(static_cast<uint32_t>(killer));
-    }
+    m_broadcastWriter.writeU8(ServerHeader::NEWS);
+    m_broadcastWriter.writeU8(NewsType::KILL);
+    m_broadcastWriter.writeRecord(
+        Protocol::KillNews{m_entityManager.getNetId(subject),
+                           m_entityManager.getNetId(killer)});
 }
 
 void GameServer::broadcastMessage(const std::string& message) {
-    for (auto& [id, client] : m_clients) {
-        client->m_writer.writeU8(ServerHeader::NEWS);
-        client->m_writer.writeU8(NewsType::TEXT);
-        client->m_writer.writeString(message);
-    }
+    m_broadcastWriter.writeU8(ServerHeader::NEWS);
+    m_broadcastWriter.writeU8(NewsType::TEXT);
+    m_broadcastWriter.writeString(message);
 }
 
-// TODO: this should maybe be serialized from within Client.cpp game state AND
-// this should not send to every client, only those who can see the trace
-void GameServer::broadcastBulletTrace(entt::entity shooter, glm::vec2 start,
-                                      glm::vec2 end) {
-    float startX = pixels(start.x);
-    float startY = pixels(start.y);
-    float endX = pixels(end.x);
-    float endY = pixels(end.y);
-
-    for (auto& [id, client] : m_clients) {
-        client->m_writer.writeU8(ServerHeader::BULLET_TRACE);
-        client->m_writer.writeU32(static_cast<uint32_t>(shooter));
-        client->m_writer.writeFloat(startX);
-        client->m_writer.writeFloat(startY);
-        client->m_writer.writeFloat(endX);
-        client->m_writer.writeFloat(endY);
-    }
+// sent with the projectile spawns to every client whose view the trace
+// crosses
+void GameServer::queueBulletTrace(entt::entity shooter, glm::vec2 start,
+                                  glm::vec2 end) {
+    m_bulletTraces.push_back(
+        {Protocol::BulletTrace{m_entityManager.getNetId(shooter),
+                               pixels(start.x), pixels(start.y),
+                               pixels(end.x), pixels(end.y)},
+         {start.x, start.y},
+         {end.x, end.y}});
 }
 
 void GameServer::setServerRegistration(ServerRegistration* registration) {
@@ -2,53 +2,107 @@
 
 #include <uwebsockets/App.h>
 
+#include <algorithm>
 #include <cstdint>
 
 #include "client/Client.hpp"
 
 uint32_t id = 0;
 
-SocketServer::SocketServer(GameServer& gameServer, uint16_t port)
-    : m_port(port), m_gameServer(gameServer) {
-    m_socketThread = std::thread(&SocketServer::run, this);
+SocketServer::SocketServer(GameServer& gameServer, uint16_t port,
+                           const SocketConfig& config)
+    : m_port(port), m_gameServer(gameServer), m_config(config) {
+    const unsigned int threadCount = std::max(1u, m_config.threads);
+
+    // register every loop before any thread starts so the game thread never
+    // sees the list change
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        m_loops.push_back(std::make_unique<SocketLoop>(m_config));
+        m_gameServer.m_socketLoops.push_back(m_loops.back().get());
+    }
+
+    for (auto& loop : m_loops) {
+        m_socketThreads.emplace_back(&SocketServer::run, this,
+                                     std::ref(*loop));
+    }
 }
 
-void SocketServer::run() {
+void SocketServer::run(SocketLoop& loop) {
     std::cout << "Starting socket server on port " << m_port << std::endl;
-    static uint32_t nextId = 0;
     uWS::App()
         .ws<WebSocketData>(
             "/*",
-            {.open =
+            {.compression = m_config.compression,
+             .maxPayloadLength = m_config.maxPayloadLength,
+             // sends past this are dropped by uWS; flush() disconnects the
+             // client when that happens
+             .maxBackpressure = static_cast<unsigned int>(m_config.sendLimit),
+             .open =
                  [&](auto* ws) {
                      std::lock_guard<std::mutex> lock(m_gameServer.m_gameMutex);
 
-                     Client* client = new Client(m_gameServer, ws, nextId++);
+                     Client* client =
+                         new Client(m_gameServer, ws, m_nextClientId++);
                      auto* data = (WebSocketData*)ws->getUserData();
                      data->id = client->m_id;
+                     data->messageBudget = TokenBucket(m_config.messageRate,
+                                                       m_config.messageBurst);
+                     data->byteBudget =
+                         TokenBucket(m_config.byteRate, m_config.byteBurst);
 
                      m_gameServer.m_clients.emplace(client->m_id, client);
+                     loop.addConnection(client);
 
                      std::cout << "Connection opened, total clients: "
                                << m_gameServer.m_clients.size() << std::endl;
                  },
 
-             //  TODO: Set max message size to prevent spam
              .message =
                  [&](auto* ws, std::string_view message, uWS::OpCode opCode) {
                      if (opCode != uWS::OpCode::BINARY) return;
-                     std::lock_guard<std::mutex> lock(m_gameServer.m_gameMutex);
 
                      auto* data = (WebSocketData*)ws->getUserData();
-                     uint32_t id = data->id;
-
-                     auto it = m_gameServer.m_clients.find(id);
 
-                     if (it != m_gameServer.m_clients.end()) {
-                         m_gameServer.m_messages.emplace_back(id, message);
-                     } else {
-                         std::cout << "Client with ID " << id << " not found"
-                                   << std::endl;
+                     // over budget frames never reach the game thread.
+                     // Dropping one could lose an edge like MOUSE_UP or
+                     // SPAWN, so the client is closed instead. Both buckets
+                     // are checked before either is spent.
+                     const auto now = TokenBucket::Clock::now();
+                     if (!data->messageBudget.canConsume(1.0, now) ||
+                         !data->byteBudget.canConsume(message.length(),
+                                                      now)) {
+                         if (data->rejectedFrames++ == 0) {
+                             std::cout << "Closing client " << data->id
+                                       << ", over inbound rate limit"
+                                       << std::endl;
+                             ws->end(1008, "Rate limited");
+                         }
+                         loop.recordRejectedFrame();
+                         return;
+                     }
+                     data->messageBudget.consume(1.0, now);
+                     data->byteBudget.consume(message.length(), now);
+
+                     switch (loop.receive(*data, message)) {
+                         case SocketLoop::ReceiveResult::QUEUE_FULL:
+                             if (data->droppedFrames++ == 0) {
+                                 std::cout << "Inbound queue full, dropping "
+                                           << "frames from " << data->id
+                                           << std::endl;
+                             }
+                             loop.recordDroppedFrame();
+                             break;
+                         case SocketLoop::ReceiveResult::MALFORMED:
+                             if (data->malformedFrames >
+                                 m_config.maxMalformedFrames) {
+                                 std::cout << "Closing client " << data->id
+                                           << ", too many malformed frames"
+                                           << std::endl;
+                                 ws->end(1008, "Malformed frames");
+                             }
+                             break;
+                         case SocketLoop::ReceiveResult::OK:
+                             break;
                      }
                  },
              .close =
@@ -62,16 +116,11 @@ void SocketServer::run() {
                          m_gameServer.m_entityManager.scheduleForRemoval(
                              client->m_entity);
 
-                         // remove this client's messages
-                         m_gameServer.m_messages.erase(
-                             std::remove_if(m_gameServer.m_messages.begin(),
-                                            m_gameServer.m_messages.end(),
-                                            [id](const auto& message) {
-                                                return message.first == id;
-                                            }),
-                             m_gameServer.m_messages.end());
+                         // frames still queued for this id are dropped when
+                         // the tick drains the queue and cannot find it
 
                          client->onClose();
+                         loop.removeConnection(client);
                          delete client;
                          m_gameServer.m_clients.erase(it);
                      }
@@ -84,10 +133,12 @@ void SocketServer::run() {
                  // hello
                  res->end("Welcome to the homepage!");
              })
-        .listen(this->m_port,
-                [this](auto* socket) {
+        // uSockets sets SO_REUSEPORT unless LIBUS_LISTEN_EXCLUSIVE_PORT is
+        // passed, which lets every socket thread bind the same port
+        .listen(this->m_port, LIBUS_LISTEN_DEFAULT,
+                [this, &loop](auto* socket) {
                     if (socket) {
-                        m_gameServer.m_socketLoop = uWS::Loop::get();
+                        loop.setLoop(uWS::Loop::get());
                     } else {
                         std::cerr << "Failed to listen on port " << this->m_port
                                   << std::endl;
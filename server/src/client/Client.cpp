@@ -2,6 +2,7 @@
 
 #include <box2d/box2d.h>
 
+#include <algorithm>
 #include <iostream>
 #include <unordered_set>
 
@@ -10,6 +11,7 @@
 #include "common/enums.hpp"
 #include "ecs/EntityManager.hpp"
 #include "ecs/components.hpp"
+#include "packet/Quantize.hpp"
 #include "packet/buffer/PacketReader.hpp"
 #include "physics/CollisionHelpers.hpp"
 #include "physics/PhysicsWorld.hpp"
@@ -20,23 +22,19 @@ Client::Client(GameServer& gameServer,
     : m_gameServer(gameServer), m_ws(ws), m_id(id) {
     changeBody(m_gameServer.m_entityManager.createSpectator(entt::null));
 
-    // send server tps
-    m_writer.writeU8(ServerHeader::TPS);
-    m_writer.writeU8(m_gameServer.m_tps);
+    // server tps, map size and game config, serialized once at startup
+    queueSharedBuffer(m_gameServer.m_handshakeBuffer);
 
-    m_writer.writeU8(ServerHeader::MAP_INIT);
-    m_writer.writeU32(
-        static_cast<uint32_t>(m_gameServer.m_worldGenerator->GetWorldSize()));
-
-    m_writer.writeU8(ServerHeader::GAME_CONFIG);
-    m_writer.writeString(m_gameServer.m_gameConfig.toJsonString());
-
-    // tell our player about others
+    // tell our player about others. This goes in the shared queue too so it
+    // is sent ahead of any broadcast that refers to these players.
+    PacketWriter players;
     for (auto& [id, client] : m_gameServer.m_clients) {
-        m_writer.writeU8(ServerHeader::PLAYER_JOIN);
-        m_writer.writeU32(static_cast<uint32_t>(client->m_entity));
-        m_writer.writeString(client->m_name);
+        players.writeU8(ServerHeader::PLAYER_JOIN);
+        players.writeU16(
+            m_gameServer.m_entityManager.getNetId(client->m_entity));
+        players.writeString(client->m_name);
     }
+    if (players.hasData()) queueSharedBuffer(players.share());
 }
 
 Client::~Client() {}
@@ -44,37 +42,18 @@ Client::~Client() {}
 void Client::onMessage(const std::string_view& message) {
     m_reader.loadMessage(message);
 
-    while (m_reader.getOffset() < m_reader.byteLength()) {
+    // the socket thread only forwards complete messages, but a short read
+    // just stops here instead of throwing
+    while (!m_reader.failed() && m_reader.getOffset() < m_reader.byteLength()) {
         const uint8_t header = m_reader.readU8();
 
         switch (header) {
             case ClientHeader::SPAWN:
                 onSpawn();
                 break;
-            case ClientHeader::MOUSE:
-                onMouse();
-                break;
-            case ClientHeader::MOVEMENT:
-                onMovement();
-                break;
-            case ClientHeader::MOUSE_DOWN:
-                onMouseClick(true);
-                break;
-            case ClientHeader::MOUSE_UP:
-                onMouseClick(false);
-                break;
             case ClientHeader::CLIENT_CHAT:
                 onChat();
                 break;
-            case ClientHeader::RELOAD:
-                onReload();
-                break;
-            case ClientHeader::SWITCH_ITEM:
-                onSwitchItem();
-                break;
-            case ClientHeader::PICKUP_REQUEST:
-                onPickupRequest();
-                break;
         }
     }
 }
@@ -83,6 +62,7 @@ void Client::onSpawn() {
     if (m_active) return;
 
     std::string name = m_reader.readString();
+    if (m_reader.failed()) return;
 
     m_name = name;
     m_active = true;
@@ -91,144 +71,224 @@ void Client::onSpawn() {
     m_gameServer.m_entityManager.scheduleForRemoval(m_entity);
     changeBody(m_gameServer.m_entityManager.createPlayer());
 
+    const uint16_t netId = m_gameServer.m_entityManager.getNetId(m_entity);
     m_writer.writeU8(ServerHeader::SPAWN_SUCCESS);
-    m_writer.writeU32(static_cast<uint32_t>(m_entity));
+    m_writer.writeU16(netId);
     std::cout << "User " << m_name << " has connected" << std::endl;
 
     // serialize the client with the map data
     sendTerrainMeshes();
 
     // notify clients about our new player
-    for (auto& [id, client] : m_gameServer.m_clients) {
-        client->m_writer.writeU8(ServerHeader::PLAYER_JOIN);
-        client->m_writer.writeU32(static_cast<uint32_t>(m_entity));
-        client->m_writer.writeString(m_name);
-
-        client->m_writer.writeU8(ServerHeader::NEWS);
-        client->m_writer.writeU8(NewsType::TEXT);
-        client->m_writer.writeString(m_name + " has joined the game!!");
-    }
+    PacketWriter& broadcast = m_gameServer.m_broadcastWriter;
+    broadcast.writeU8(ServerHeader::PLAYER_JOIN);
+    broadcast.writeU16(netId);
+    broadcast.writeString(m_name);
+
+    broadcast.writeU8(ServerHeader::NEWS);
+    broadcast.writeU8(NewsType::TEXT);
+    broadcast.writeString(m_name + " has joined the game!!");
 }
 
 void Client::onClose() {
-    for (auto& [id, client] : m_gameServer.m_clients) {
-        if (client != this) {
-            client->m_writer.writeU8(ServerHeader::PLAYER_LEAVE);
-            client->m_writer.writeU32(static_cast<uint32_t>(m_entity));
+    // we are gone before the next broadcast goes out
+    PacketWriter& broadcast = m_gameServer.m_broadcastWriter;
+    broadcast.writeU8(ServerHeader::PLAYER_LEAVE);
+    broadcast.writeU16(m_gameServer.m_entityManager.getNetId(m_entity));
+
+    entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
+    for (const auto& [netId, entity] : m_previousVisible) {
+        if (auto* observers = reg.try_get<Components::Observers>(entity)) {
+            observers->remove(m_id);
         }
     }
 }
 
-void Client::onMouse() {
-    const float angle = m_reader.readFloat();
+void Client::onChat() {
+    std::string message = m_reader.readString();
 
-    if (!m_active) {
+    if (m_reader.failed() || !m_active) {
         return;
     }
 
-    entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
-    assert(reg.all_of<Components::Input>(m_entity));
-    Components::Input& input = reg.get<Components::Input>(m_entity);
-    input.angle = angle;
-}
-
-void Client::onMovement() {
-    const uint8_t direction = m_reader.readU8();
-
-    if (!m_active) {
+    if (message.length() > 50) {
         return;
     }
 
     entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
-    assert(reg.all_of<Components::Input>(m_entity));
-    Components::Input& input = reg.get<Components::Input>(m_entity);
-    input.direction = direction;
+    auto* observers = reg.try_get<Components::Observers>(m_entity);
+    if (!observers) return;
+
+    const uint16_t netId = m_gameServer.m_entityManager.getNetId(m_entity);
+    for (uint32_t id : observers->clients) {
+        auto it = m_gameServer.m_clients.find(id);
+        if (it == m_gameServer.m_clients.end()) continue;
+
+        Client* client = it->second;
+        client->m_writer.writeU8(ServerHeader::SERVER_CHAT);
+        client->m_writer.writeU16(netId);
+        client->m_writer.writeString(message);
+    }
 }
 
-void Client::onMouseClick(bool isDown) {
+void Client::applyInput() {
+    auto* data = static_cast<WebSocketData*>(m_ws->getUserData());
+    // always take so edges from before spawning are not replayed later
+    InputSlot::State state = data->input.take();
+    m_ackedTick = std::max(m_ackedTick, state.snapshotAck);
+
     if (!m_active) {
         return;
     }
 
     entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
-    assert(reg.all_of<Components::Input>(m_entity));
+    if (!reg.all_of<Components::Input>(m_entity)) return;
     Components::Input& input = reg.get<Components::Input>(m_entity);
 
-    input.mouseIsDown = isDown;
-    if (isDown) input.dirtyClick = true;
+    input.angle = state.angle;
+    input.direction = state.direction;
+    input.mouseIsDown = state.mouseDown;
+    if (state.edges & InputSlot::CLICK) input.dirtyClick = true;
+    if (state.edges & InputSlot::RELOAD) input.reloadRequested = true;
+    if (state.edges & InputSlot::PICKUP) input.pickupRequested = true;
+    if (state.switchSlot >= 0) input.switchSlot = state.switchSlot;
 }
 
-void Client::onChat() {
-    std::string message = m_reader.readString();
+float Client::updateWeight(entt::entity entity, const b2Vec2& camera) {
+    entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
+    b2BodyId bodyId = reg.get<Components::EntityBase>(entity).bodyId;
+
+    // An entity at the camera gains priority twice as fast as one 20m away,
+    // and one moving at 10m/s twice as fast as one standing still
+    constexpr float DISTANCE_SCALE = 20.0f;
+    constexpr float SPEED_SCALE = 10.0f;
+    float distance = b2Distance(b2Body_GetPosition(bodyId), camera);
+    float speed = b2Length(b2Body_GetLinearVelocity(bodyId));
+    return (1.0f + speed / SPEED_SCALE) / (1.0f + distance / DISTANCE_SCALE);
+}
 
-    if (!m_active) {
-        return;
-    }
+void Client::applyUpdateBudget(const std::vector<EntitySnapshot>* baseline,
+                               const b2Vec2& camera) {
+    static const std::vector<EntitySnapshot> empty;
+    const std::vector<EntitySnapshot>& previous = baseline ? *baseline : empty;
+
+    // every entity that differs from the baseline competes for the budget
+    m_updateCandidates.clear();
+    size_t index = 0;
+    for (size_t i = 0; i < m_currentSnapshot.size(); ++i) {
+        const EntitySnapshot& entity = m_currentSnapshot[i];
+        while (index < previous.size() && previous[index].id < entity.id) {
+            ++index;
+        }
 
-    if (message.length() > 50) {
-        return;
+        const EntitySnapshot* old = nullptr;
+        if (index < previous.size() && previous[index].id == entity.id) {
+            old = &previous[index];
+            if (old->x == entity.x && old->y == entity.y &&
+                old->angle == entity.angle) {
+                continue;
+            }
+        }
+
+        // priority keeps accumulating while an entity is deferred, so even
+        // distant ones are sent eventually
+        float& priority = m_updatePriority[entity.id];
+        priority += updateWeight(m_updateEntities[i].second, camera);
+        m_updateCandidates.push_back(
+            {i, old, priority, SnapshotHistory::entryBits(old, entity)});
     }
 
-    for (auto& [id, client] : m_gameServer.m_clients) {
-        if (client->m_previousVisibleEntities.find(m_entity) !=
-            client->m_previousVisibleEntities.end()) {
-            client->m_writer.writeU8(ServerHeader::SERVER_CHAT);
-            client->m_writer.writeU32(static_cast<uint32_t>(m_entity));
-            client->m_writer.writeString(message);
+    std::sort(m_updateCandidates.begin(), m_updateCandidates.end(),
+              [](const UpdateCandidate& a, const UpdateCandidate& b) {
+                  return a.priority > b.priority;
+              });
+
+    constexpr uint16_t DEFERRED = NetIdAllocator::NULL_ID;
+    const size_t budgetBits = m_gameServer.m_snapshotBudget * 8;
+    size_t spentBits = 0;
+    bool deferredNew = false;
+
+    for (const UpdateCandidate& candidate : m_updateCandidates) {
+        EntitySnapshot& entity = m_currentSnapshot[candidate.index];
+        if (spentBits + candidate.bits <= budgetBits) {
+            spentBits += candidate.bits;
+            m_updatePriority[entity.id] = 0.0f;
+        } else if (candidate.baseline) {
+            // the client keeps the acked state, which emits no entry
+            entity = *candidate.baseline;
+        } else {
+            entity.id = DEFERRED;
+            deferredNew = true;
         }
     }
-}
 
-void Client::onReload() {
-    if (!m_active) {
-        return;
+    if (deferredNew) {
+        m_currentSnapshot.erase(
+            std::remove_if(m_currentSnapshot.begin(), m_currentSnapshot.end(),
+                           [](const EntitySnapshot& entity) {
+                               return entity.id == DEFERRED;
+                           }),
+            m_currentSnapshot.end());
     }
+}
 
+void Client::writeEntityUpdates(const b2Vec2& camera) {
     entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
-    if (!reg.all_of<Components::Input>(m_entity)) return;
-    Components::Input& input = reg.get<Components::Input>(m_entity);
-    input.reloadRequested = true;
-}
 
-void Client::onSwitchItem() {
-    if (!m_active) {
-        return;
+    // already in net id order, like the snapshots
+    m_currentSnapshot.clear();
+    m_currentSnapshot.reserve(m_updateEntities.size());
+    for (const auto& [netId, entity] : m_updateEntities) {
+        b2BodyId bodyId = reg.get<Components::EntityBase>(entity).bodyId;
+        assert(B2_IS_NON_NULL(bodyId));
+        const b2Vec2& position = b2Body_GetPosition(bodyId);
+
+        m_currentSnapshot.push_back(
+            {netId, quantizePosition(pixels(position.x)),
+             quantizePosition(pixels(position.y)),
+             quantizeAngle(b2Rot_GetAngle(b2Body_GetRotation(bodyId)))});
     }
 
-    const uint8_t slot = m_reader.readU8();
+    const uint32_t tick = static_cast<uint32_t>(m_gameServer.m_currentTick);
+    const std::vector<EntitySnapshot>* baseline = m_snapshots.find(m_ackedTick);
+    applyUpdateBudget(baseline, camera);
 
-    entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
-    if (!reg.all_of<Components::Input>(m_entity)) return;
-    Components::Input& input = reg.get<Components::Input>(m_entity);
-    input.switchSlot = static_cast<int8_t>(slot);
-}
+    m_deltaWriter.clear();
+    uint32_t count =
+        SnapshotHistory::writeDelta(m_deltaWriter, baseline, m_currentSnapshot);
 
-void Client::onPickupRequest() {
-    if (!m_active) {
-        return;
-    }
+    // nothing changed since the baseline: send nothing and keep acking it
+    if (count == 0) return;
 
-    entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
-    if (!reg.all_of<Components::Input>(m_entity)) return;
-    Components::Input& input = reg.get<Components::Input>(m_entity);
-    input.pickupRequested = true;
+    m_snapshotWriter.writeU8(ServerHeader::ENTITY_UPDATE);
+    m_snapshotWriter.writeU32(tick);
+    // 0 tells the client to start from an empty snapshot
+    m_snapshotWriter.writeU32(baseline ? m_ackedTick : 0);
+    m_snapshotWriter.writeU16(static_cast<uint16_t>(count));
+    m_snapshotWriter.appendRaw(m_deltaWriter.getMessage());
+
+    m_snapshots.store(tick, m_currentSnapshot);
 }
 
-void Client::writeGameState() {
+void Client::writeGameState(GameStateScratch& scratch) {
     entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
 
     assert(reg.all_of<Components::Camera>(m_entity));
 
-    // Static variables to avoid repeated allocations
-    static std::vector<entt::entity> createEntities;
-    static std::vector<entt::entity> updateEntities;
-    static std::vector<entt::entity> removeEntities;
-    static std::unordered_set<entt::entity> currentlyVisibleEntities;
+    std::vector<std::pair<uint16_t, entt::entity>>& visible = scratch.visible;
+    std::vector<entt::entity>& createEntities = scratch.createEntities;
+    std::vector<uint16_t>& removeIds = scratch.removeIds;
 
+    visible.clear();
     createEntities.clear();
-    updateEntities.clear();
-    removeEntities.clear();
-    currentlyVisibleEntities.clear();
+    removeIds.clear();
+    m_updateEntities.clear();
+
+    EntityManager& entityManager = m_gameServer.m_entityManager;
+
+    // a snapshot the socket thread never picked up is stale now, the latest
+    // one replaces it
+    m_snapshotWriter.clear();
 
     Components::Camera& cam = reg.get<Components::Camera>(m_entity);
     bool targetValid = (cam.target != entt::null && reg.valid(cam.target));
@@ -243,61 +303,78 @@ void Client::writeGameState() {
     queryAABB.lowerBound = {pos.x - halfViewX, pos.y - halfViewY};
     queryAABB.upperBound = {pos.x + halfViewX, pos.y + halfViewY};
 
-    PhysicsWorld& physicsWorld = m_gameServer.m_physicsWorld;
-
-    // In Box2D v3, we query all networked entities manually instead of using
-    // QueryAABB callback
+    // only the grid cells under the camera are walked
     auto networkedView =
         reg.view<Components::EntityBase, Components::Networked>();
-    std::vector<entt::entity> visibleNetworkedEntities;
 
-    for (auto entity : networkedView) {
+    m_gameServer.m_spatialGrid.query(queryAABB, [&](entt::entity entity) {
+        // no id left to name it by, clients cannot be told about it
+        auto& networked = networkedView.get<Components::Networked>(entity);
+        if (networked.netId == NetIdAllocator::NULL_ID) return;
+
         auto& base = networkedView.get<Components::EntityBase>(entity);
         if (B2_IS_NON_NULL(base.bodyId)) {
             if (!b2Body_IsEnabled(base.bodyId)) {
-                continue;
+                return;
             }
             b2Vec2 entityPos = b2Body_GetPosition(base.bodyId);
             if (AABBCollision::pointInAABB(entityPos, queryAABB)) {
-                visibleNetworkedEntities.push_back(entity);
+                visible.emplace_back(networked.netId, entity);
             }
         }
-    }
+    });
 
-    for (const entt::entity& entity : visibleNetworkedEntities) {
-        currentlyVisibleEntities.insert(entity);
-    }
+    // both lists are sorted by net id, so one merge walk splits them into
+    // creates, updates and removes
+    std::sort(visible.begin(), visible.end());
 
     auto baseView = reg.view<Components::EntityBase>();
-    auto stateView = reg.view<Components::State>();
 
-    // most of these entities are going to go into the update list
-    createEntities.reserve(currentlyVisibleEntities.size());
-    updateEntities.reserve(currentlyVisibleEntities.size());
+    size_t previous = 0;
+    for (const auto& [netId, entity] : visible) {
+        // by id, the entity may already be destroyed
+        while (previous < m_previousVisible.size() &&
+               m_previousVisible[previous].first < netId) {
+            removeIds.push_back(m_previousVisible[previous].first);
+            m_stoppedObserving.push_back(m_previousVisible[previous].second);
+            ++previous;
+        }
 
-    for (const entt::entity& entity : currentlyVisibleEntities) {
-        if (m_previousVisibleEntities.find(entity) ==
-            m_previousVisibleEntities.end()) {
-            createEntities.push_back(entity);
-        } else {
+        if (previous < m_previousVisible.size() &&
+            m_previousVisible[previous].first == netId) {
+            ++previous;
             // Only send updates for dynamic bodies (skip static structures)
             auto& base = baseView.get<Components::EntityBase>(entity);
             if (B2_IS_NON_NULL(base.bodyId) &&
                 b2Body_GetType(base.bodyId) != b2_staticBody) {
-                updateEntities.push_back(entity);
+                m_updateEntities.emplace_back(netId, entity);
             }
+        } else {
+            createEntities.push_back(entity);
+            m_startedObserving.push_back(entity);
         }
     }
-
-    for (const entt::entity& entity : m_previousVisibleEntities) {
-        if (currentlyVisibleEntities.find(entity) ==
-            currentlyVisibleEntities.end()) {
-            removeEntities.push_back(entity);
-        }
+    for (; previous < m_previousVisible.size(); ++previous) {
+        removeIds.push_back(m_previousVisible[previous].first);
+        m_stoppedObserving.push_back(m_previousVisible[previous].second);
     }
 
+    // entity positions are sent relative to the camera centre
+    const Protocol::SnapshotOrigin origin{pixels(pos.x), pixels(pos.y)};
+    auto offsetX = [&](float x) {
+        return quantizeOffset(pixels(x) - origin.x);
+    };
+    auto offsetY = [&](float y) {
+        return quantizeOffset(pixels(y) - origin.y);
+    };
+
     if (!createEntities.empty()) {
+        m_writer.reserve(5 + Protocol::SnapshotOrigin::SIZE +
+                         createEntities.size() *
+                             (Protocol::EntityCreate::SIZE +
+                              Protocol::PickupInfo::SIZE));
         m_writer.writeU8(ServerHeader::ENTITY_CREATE);
+        m_writer.writeRecord(origin);
         m_writer.writeU32(static_cast<uint32_t>(createEntities.size()));
 
         for (entt::entity entity : createEntities) {
@@ -309,12 +386,10 @@ void Client::writeGameState() {
             const b2Vec2& position = b2Body_GetPosition(bodyId);
             uint8_t type = base.type;
 
-            m_writer.writeU32(static_cast<uint32_t>(entity));
-            m_writer.writeU8(type);
-            m_writer.writeU8(base.variant);
-            m_writer.writeFloat(pixels(position.x));
-            m_writer.writeFloat(pixels(position.y));
-            m_writer.writeFloat(b2Rot_GetAngle(b2Body_GetRotation(bodyId)));
+            m_writer.writeRecord(Protocol::EntityCreate{
+                entityManager.getNetId(entity), type, base.variant,
+                offsetX(position.x), offsetY(position.y),
+                quantizeAngle(b2Rot_GetAngle(b2Body_GetRotation(bodyId)))});
 
             // TODO: we can prob improve this part
             if (base.type == EntityTypes::GUN_PICKUP ||
@@ -322,57 +397,40 @@ void Client::writeGameState() {
                 if (reg.all_of<Components::GroundItem>(entity)) {
                     const auto& groundItem =
                         reg.get<Components::GroundItem>(entity);
-                    m_writer.writeU8(static_cast<uint8_t>(groundItem.itemType));
-                    m_writer.writeU8(static_cast<uint8_t>(groundItem.ammoType));
-                    m_writer.writeU16(
-                        static_cast<uint16_t>(groundItem.ammoAmount));
+                    m_writer.writeRecord(Protocol::PickupInfo{
+                        static_cast<uint8_t>(groundItem.itemType),
+                        static_cast<uint8_t>(groundItem.ammoType),
+                        static_cast<uint16_t>(groundItem.ammoAmount)});
                 } else {
-                    m_writer.writeU8(static_cast<uint8_t>(ItemType::ITEM_NONE));
-                    m_writer.writeU8(static_cast<uint8_t>(AmmoType::LIGHT));
-                    m_writer.writeU16(0);
+                    m_writer.writeRecord(Protocol::PickupInfo{
+                        static_cast<uint8_t>(ItemType::ITEM_NONE),
+                        static_cast<uint8_t>(AmmoType::LIGHT), 0});
                 }
             }
         }
     }
 
-    if (!updateEntities.empty()) {
-        m_writer.writeU8(ServerHeader::ENTITY_UPDATE);
-        m_writer.writeU32(static_cast<uint32_t>(updateEntities.size()));
-
-        for (const entt::entity& entity : updateEntities) {
-            assert(reg.all_of<Components::EntityBase>(entity));
-
-            auto& base = baseView.get<Components::EntityBase>(entity);
-            b2BodyId bodyId = base.bodyId;
-            assert(B2_IS_NON_NULL(bodyId));
-            const b2Vec2& position = b2Body_GetPosition(bodyId);
-
-            m_writer.writeU32(static_cast<uint32_t>(entity));
-            m_writer.writeFloat(pixels(position.x));
-            m_writer.writeFloat(pixels(position.y));
-            m_writer.writeFloat(b2Rot_GetAngle(b2Body_GetRotation(bodyId)));
-        }
-    }
+    writeEntityUpdates(pos);
 
-    if (!removeEntities.empty()) {
+    if (!removeIds.empty()) {
         m_writer.writeU8(ServerHeader::ENTITY_REMOVE);
-        m_writer.writeU32(static_cast<uint32_t>(removeEntities.size()));
+        m_writer.writeU32(static_cast<uint32_t>(removeIds.size()));
 
-        for (entt::entity entity : removeEntities) {
-            m_writer.writeU32(static_cast<uint32_t>(entity));
+        for (uint16_t netId : removeIds) {
+            m_writer.writeU16(netId);
+            m_updatePriority.erase(netId);
         }
     }
 
-    // Write entity states - iterate through currentlyVisibleEntities instead of
-    // query result
-    for (entt::entity entity : currentlyVisibleEntities) {
+    // Write entity states for everything visible
+    for (const auto& [netId, entity] : visible) {
         // if entity has state component, notify client of the state
         if (reg.all_of<Components::State>(entity)) {
             Components::State& state = reg.get<Components::State>(entity);
             if (!state.isIdle()) {
-                m_writer.writeU8(ServerHeader::ENTITY_STATE);
-                m_writer.writeU32(static_cast<uint32_t>(entity));
-                m_writer.writeU8(state.state);
+                m_snapshotWriter.writeU8(ServerHeader::ENTITY_STATE);
+                m_snapshotWriter.writeRecord(
+                    Protocol::EntityState{netId, state.state});
             }
         }
     }
@@ -434,21 +492,103 @@ void Client::writeGameState() {
             reg.all_of<Components::Ammo>(m_entity)) {
             Components::Ammo& ammo = reg.get<Components::Ammo>(m_entity);
             m_writer.writeU8(ServerHeader::AMMO_UPDATE);
-            m_writer.writeU16(static_cast<uint16_t>(activeSlot.gun.ammoInMag));
-            m_writer.writeU16(
-                static_cast<uint16_t>(ammo.get(activeSlot.gun.ammoType)));
-            m_writer.writeFloat(activeSlot.gun.reloadRemaining);
+            m_writer.writeRecord(Protocol::AmmoUpdate{
+                static_cast<uint16_t>(activeSlot.gun.ammoInMag),
+                static_cast<uint16_t>(ammo.get(activeSlot.gun.ammoType)),
+                activeSlot.gun.reloadRemaining});
         }
     }
 
-    m_previousVisibleEntities.swap(currentlyVisibleEntities);
+    m_previousVisible.swap(visible);
 }
 
-void Client::sendBytes() {
-    if (!m_writer.hasData()) return;
+void Client::updateObservers() {
+    entt::registry& reg = m_gameServer.m_entityManager.getRegistry();
+
+    for (entt::entity entity : m_startedObserving) {
+        if (!reg.valid(entity)) continue;
+        reg.get_or_emplace<Components::Observers>(entity).add(m_id);
+    }
+    // destroyed entities took their observers with them
+    for (entt::entity entity : m_stoppedObserving) {
+        if (!reg.valid(entity)) continue;
+        if (auto* observers = reg.try_get<Components::Observers>(entity)) {
+            observers->remove(m_id);
+        }
+    }
 
-    m_ws->send(m_writer.getMessage(), uWS::OpCode::BINARY);
-    m_writer.clear();
+    m_startedObserving.clear();
+    m_stoppedObserving.clear();
+}
+
+void Client::queueSharedBuffer(const SharedBuffer& buffer) {
+    m_sharedBuffers.push_back(buffer);
+}
+
+void Client::publish() {
+    if (!m_writer.hasData() && !m_snapshotWriter.hasData() &&
+        m_sharedBuffers.empty()) {
+        return;
+    }
+
+    // The socket thread has not sent the last frame yet; keep appending to the
+    // front buffer and try again next tick.
+    if (m_sendPending.load(std::memory_order_acquire)) return;
+
+    m_writer.swap(m_sendWriter);
+    m_snapshotWriter.swap(m_sendSnapshotWriter);
+    m_sharedBuffers.swap(m_sendSharedBuffers);
+    m_sendPending.store(true, std::memory_order_release);
+}
+
+Client::SendResult Client::sendBytes(const SocketConfig& config) {
+    if (!m_sendPending.load(std::memory_order_acquire)) {
+        return SendResult::SENT;
+    }
+
+    SendResult result = SendResult::SENT;
+    bool dropped = false;
+
+    auto send = [&](std::string_view message) {
+        bool compress = message.length() >= config.compressionThreshold;
+        auto status = m_ws->send(message, uWS::OpCode::BINARY, compress);
+        if (status == uWS::WebSocket<false, true, WebSocketData>::DROPPED) {
+            dropped = true;
+        }
+    };
+
+    // bytes still waiting from earlier ticks, the corked sends below are not
+    // counted until they are written
+    const size_t buffered = m_ws->getBufferedAmount();
+
+    // batch the shared buffers and the frame into as few syscalls as we can
+    m_ws->cork([&]() {
+        for (const SharedBuffer& buffer : m_sendSharedBuffers) {
+            send(*buffer);
+        }
+        if (m_sendWriter.hasData()) {
+            send(m_sendWriter.getMessage());
+        }
+        // a client that is already behind would only queue stale positions
+        if (m_sendSnapshotWriter.hasData()) {
+            if (buffered < config.sendWatermark) {
+                send(m_sendSnapshotWriter.getMessage());
+            } else {
+                result = SendResult::SNAPSHOT_SKIPPED;
+            }
+        }
+    });
+
+    m_sendSharedBuffers.clear();
+    m_sendWriter.clear();
+    m_sendSnapshotWriter.clear();
+    m_sendPending.store(false, std::memory_order_release);
+
+    // a dropped reliable event cannot be recovered, the client has to go
+    if (dropped || m_ws->getBufferedAmount() > config.sendLimit) {
+        return SendResult::OVER_LIMIT;
+    }
+    return result;
 }
 
 void Client::changeBody(entt::entity entity) {
@@ -463,54 +603,14 @@ void Client::changeBody(entt::entity entity) {
     // write set-camera packet with cam target entity
     m_writer.writeU8(ServerHeader::SET_CAMERA);
     Components::Camera& cam = reg.get<Components::Camera>(entity);
-    m_writer.writeU32(static_cast<uint32_t>(cam.target));
+    m_writer.writeU16(m_gameServer.m_entityManager.getNetId(cam.target));
 }
 
-// Send all terrain meshes once to this client. Uses a compact vertex encoding
-// when the world fits in 16-bit grid coordinates; otherwise falls back to
-// floats.
+// Send all terrain meshes once to this client. The meshes are serialized once
+// by GameServer, so this only queues a reference.
 void Client::sendTerrainMeshes() {
     if (m_sentTerrainMeshes) return;
 
-    const auto& meshes = m_gameServer.m_terrainMeshes;
-    const uint32_t worldSize = m_gameServer.m_worldGenerator->GetWorldSize();
-    const bool useU16 = worldSize <= std::numeric_limits<uint16_t>::max();
-
-    for (size_t biomeIdx = 0; biomeIdx < meshes.size(); ++biomeIdx) {
-        const TerrainMesh& mesh = meshes[biomeIdx];
-
-        m_writer.writeU8(ServerHeader::BIOME_CREATE);
-        m_writer.writeU32(static_cast<uint32_t>(biomeIdx));
-        m_writer.writeU8(static_cast<uint8_t>(mesh.biome));
-
-        // Encoding flag: 0 = float world pixels, 1 = uint16 heightmap units
-        m_writer.writeU8(useU16 ? 1 : 0);
-
-        // Write vertices
-        m_writer.writeU32(static_cast<uint32_t>(mesh.vertices.size()));
-        if (useU16) {
-            for (const Vec2& v : mesh.vertices) {
-                // Clamp to u16 bounds just in case
-                uint16_t vx = static_cast<uint16_t>(
-                    std::clamp(v.x, 0.0f, static_cast<float>(worldSize)));
-                uint16_t vy = static_cast<uint16_t>(
-                    std::clamp(v.y, 0.0f, static_cast<float>(worldSize)));
-                m_writer.writeU16(vx);
-                m_writer.writeU16(vy);
-            }
-        } else {
-            for (const Vec2& v : mesh.vertices) {
-                m_writer.writeFloat(v.x * 64.0f);
-                m_writer.writeFloat(v.y * 64.0f);
-            }
-        }
-
-        // Write indices
-        m_writer.writeU32(static_cast<uint32_t>(mesh.indices.size()));
-        for (uint32_t idx : mesh.indices) {
-            m_writer.writeU32(idx);
-        }
-    }
-
+    queueSharedBuffer(m_gameServer.m_terrainBuffer);
     m_sentTerrainMeshes = true;
 }
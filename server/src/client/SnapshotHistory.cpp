@@ -0,0 +1,101 @@
+#include "client/SnapshotHistory.hpp"
+
+#include "packet/Protocol.hpp"
+
+namespace {
+
+size_t varintBits(uint32_t value) {
+    size_t groups = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++groups;
+    }
+    return groups * 8;
+}
+
+size_t zigzagBits(int32_t value) {
+    return varintBits((static_cast<uint32_t>(value) << 1) ^
+                      static_cast<uint32_t>(value >> 31));
+}
+
+}  // namespace
+
+const std::vector<EntitySnapshot>* SnapshotHistory::find(uint32_t tick) const {
+    const Slot& slot = m_slots[tick % SIZE];
+    return tick != 0 && slot.tick == tick ? &slot.entities : nullptr;
+}
+
+void SnapshotHistory::store(uint32_t tick,
+                            std::vector<EntitySnapshot>& entities) {
+    Slot& slot = m_slots[tick % SIZE];
+    slot.tick = tick;
+    slot.entities.swap(entities);
+}
+
+size_t SnapshotHistory::entryBits(const EntitySnapshot* previous,
+                                  const EntitySnapshot& current) {
+    size_t bits = 8 + 2;
+    if (!previous) {
+        return bits + zigzagBits(current.x) + zigzagBits(current.y) + 16;
+    }
+
+    bits += 2;
+    if (current.x != previous->x || current.y != previous->y) {
+        bits += zigzagBits(current.x - previous->x);
+        bits += zigzagBits(current.y - previous->y);
+    }
+    if (current.angle != previous->angle) bits += 16;
+    return bits;
+}
+
+uint32_t SnapshotHistory::writeDelta(
+    BitWriter& writer, const std::vector<EntitySnapshot>* baseline,
+    const std::vector<EntitySnapshot>& current) {
+    static const std::vector<EntitySnapshot> empty;
+    const std::vector<EntitySnapshot>& previous = baseline ? *baseline : empty;
+
+    uint32_t count = 0;
+    uint32_t previousId = 0;
+
+    // ids are written as the gap from the previous entry, plus a 2 bit kind
+    auto writeEntry = [&](uint32_t id, uint32_t kind) {
+        writer.writeVarU32(id - previousId);
+        writer.writeBits(kind, 2);
+        previousId = id;
+        ++count;
+    };
+
+    size_t index = 0;
+    for (const EntitySnapshot& entity : current) {
+        while (index < previous.size() && previous[index].id < entity.id) {
+            writeEntry(previous[index++].id, Protocol::SNAPSHOT_REMOVED);
+        }
+
+        if (index < previous.size() && previous[index].id == entity.id) {
+            const EntitySnapshot& old = previous[index++];
+            bool moved = entity.x != old.x || entity.y != old.y;
+            bool turned = entity.angle != old.angle;
+            if (!moved && !turned) continue;
+
+            writeEntry(entity.id, Protocol::SNAPSHOT_CHANGED);
+            writer.writeBool(moved);
+            if (moved) {
+                writer.writeVarS32(entity.x - old.x);
+                writer.writeVarS32(entity.y - old.y);
+            }
+            writer.writeBool(turned);
+            if (turned) writer.writeBits(entity.angle, 16);
+        } else {
+            writeEntry(entity.id, Protocol::SNAPSHOT_FULL);
+            writer.writeVarS32(entity.x);
+            writer.writeVarS32(entity.y);
+            writer.writeBits(entity.angle, 16);
+        }
+    }
+
+    while (index < previous.size()) {
+        writeEntry(previous[index++].id, Protocol::SNAPSHOT_REMOVED);
+    }
+
+    return count;
+}
@@ -3,6 +3,8 @@
 #include <box2d/box2d.h>
 #include <box2d/types.h>
 
+#include <algorithm>
+#include <cmath>
 #include <entt/entt.hpp>
 
 #include "GameServer.hpp"
@@ -10,6 +12,7 @@
 #include "ecs/GunFactory.hpp"
 #include "ecs/components.hpp"
 #include "physics/PhysicsWorld.hpp"
+#include "util/spread.hpp"
 #include "util/units.hpp"
 
 using namespace Components;
@@ -29,6 +32,20 @@ EntityManager::EntityManager(GameServer& gameServer)
     m_variants[EntityTypes::AMMO_PICKUP] = 0;
 }
 
+uint16_t EntityManager::getNetId(entt::entity entity) const {
+    if (!m_registry.valid(entity)) return NetIdAllocator::NULL_ID;
+    if (auto* networked = m_registry.try_get<Networked>(entity)) {
+        return networked->netId;
+    }
+    if (auto* projectile = m_registry.try_get<Projectile>(entity)) {
+        return projectile->netId;
+    }
+    if (auto* fan = m_registry.try_get<PelletFan>(entity)) {
+        return fan->netId;
+    }
+    return NetIdAllocator::NULL_ID;
+}
+
 uint8_t EntityManager::getVariantCount(EntityTypes type) {
     assert(m_variants.count(type));
     return m_variants[type];
@@ -57,7 +74,7 @@ entt::entity EntityManager::createPlayer() {
     entt::entity entity = m_registry.create();
 
     auto& base = m_registry.emplace<EntityBase>(entity, EntityTypes::PLAYER);
-    m_registry.emplace<Networked>(entity);
+    m_registry.emplace<Networked>(entity, m_netIds.allocate());
     m_registry.emplace<State>(entity, EntityStates::IDLE);
     m_registry.emplace<Camera>(entity, entity);
     m_registry.emplace<Input>(entity);
@@ -161,12 +178,20 @@ void EntityManager::initProjectilePool(size_t count) {
 }
 
 entt::entity EntityManager::acquireProjectile() {
+    // the shot fails rather than fly unseen when every net id is taken
+    uint16_t netId = m_netIds.allocate();
+    if (netId == NetIdAllocator::NULL_ID) return entt::null;
+
+    entt::entity entity;
     if (m_projectilePool.empty()) {
-        return createProjectileEntity();
+        entity = createProjectileEntity();
+    } else {
+        entity = m_projectilePool.back();
+        m_projectilePool.pop_back();
     }
 
-    entt::entity entity = m_projectilePool.back();
-    m_projectilePool.pop_back();
+    m_registry.get<Projectile>(entity).netId = netId;
+    m_registry.emplace<ActiveProjectile>(entity);
     return entity;
 }
 
@@ -177,9 +202,13 @@ void EntityManager::releaseProjectile(entt::entity entity) {
     auto& proj = m_registry.get<Projectile>(entity);
     auto& base = m_registry.get<EntityBase>(entity);
 
+    m_netIds.release(proj.netId);
+    m_registry.remove<ActiveProjectile, Observers>(entity);
+    proj.netId = NetIdAllocator::NULL_ID;
     proj.active = false;
     proj.remainingLife = 0.0f;
     proj.owner = entt::null;
+    proj.weapon = ItemType::ITEM_NONE;
     proj.damage = 0.0f;
     proj.spawnTick = 0;
     proj.originX = 0.0f;
@@ -201,7 +230,7 @@ entt::entity EntityManager::createCrate() {
     entt::entity entity = m_registry.create();
 
     auto& base = m_registry.emplace<EntityBase>(entity, EntityTypes::CRATE);
-    m_registry.emplace<Networked>(entity);
+    m_registry.emplace<Networked>(entity, m_netIds.allocate());
 
     Components::Destructible dest;
     m_registry.emplace<Components::Destructible>(entity, dest);
@@ -239,7 +268,7 @@ entt::entity EntityManager::createBush() {
     entt::entity entity = m_registry.create();
 
     auto& base = m_registry.emplace<EntityBase>(entity, EntityTypes::BUSH);
-    m_registry.emplace<Networked>(entity);
+    m_registry.emplace<Networked>(entity, m_netIds.allocate());
     base.variant = getRandomVariant(EntityTypes::BUSH);
 
     // Define the body
@@ -273,7 +302,7 @@ entt::entity EntityManager::createRock() {
     entt::entity entity = m_registry.create();
 
     auto& base = m_registry.emplace<EntityBase>(entity, EntityTypes::ROCK);
-    m_registry.emplace<Networked>(entity);
+    m_registry.emplace<Networked>(entity, m_netIds.allocate());
     base.variant = getRandomVariant(EntityTypes::ROCK);
 
     // Define the body
@@ -307,7 +336,7 @@ entt::entity EntityManager::createWall(float x, float y) {
     entt::entity entity = m_registry.create();
 
     auto& base = m_registry.emplace<EntityBase>(entity, EntityTypes::WALL);
-    m_registry.emplace<Networked>(entity);
+    m_registry.emplace<Networked>(entity, m_netIds.allocate());
 
     Components::Destructible dest;
     m_registry.emplace<Components::Destructible>(entity, dest);
@@ -341,7 +370,7 @@ entt::entity EntityManager::createTree(float x, float y) {
 
     auto& base = m_registry.emplace<EntityBase>(entity, EntityTypes::TREE);
     base.variant = getRandomVariant(EntityTypes::TREE);
-    m_registry.emplace<Networked>(entity);
+    m_registry.emplace<Networked>(entity, m_netIds.allocate());
 
     // Create Box2D body (static)
     b2BodyDef bodyDef = b2DefaultBodyDef();
@@ -373,7 +402,7 @@ entt::entity EntityManager::createGunPickup(const Components::Gun& gun, float x,
 
     auto& base =
         m_registry.emplace<EntityBase>(entity, EntityTypes::GUN_PICKUP);
-    m_registry.emplace<Networked>(entity);
+    m_registry.emplace<Networked>(entity, m_netIds.allocate());
 
     auto& groundItem = m_registry.emplace<GroundItem>(entity);
     groundItem.itemType = gun.itemType;
@@ -409,7 +438,7 @@ entt::entity EntityManager::createAmmoPickup(AmmoType ammoType, int amount,
 
     auto& base =
         m_registry.emplace<EntityBase>(entity, EntityTypes::AMMO_PICKUP);
-    m_registry.emplace<Networked>(entity);
+    m_registry.emplace<Networked>(entity, m_netIds.allocate());
 
     auto& groundItem = m_registry.emplace<GroundItem>(entity);
     groundItem.itemType = ItemType::ITEM_NONE;
@@ -438,12 +467,51 @@ entt::entity EntityManager::createAmmoPickup(AmmoType ammoType, int amount,
     return entity;
 }
 
+entt::entity EntityManager::createPelletFan(entt::entity owner,
+                                            const Gun& gun, uint64_t tick,
+                                            b2Vec2 origin, float angle) {
+    uint16_t netId = m_netIds.allocate();
+    if (netId == NetIdAllocator::NULL_ID) return entt::null;
+
+    entt::entity entity = m_registry.create();
+    auto& fan = m_registry.emplace<PelletFan>(entity);
+
+    fan.netId = netId;
+    fan.owner = owner;
+    fan.weapon = gun.itemType;
+    fan.damage = gun.damage;
+    fan.remainingLife = gun.projectileLifetime;
+    fan.spawnTick = tick;
+    fan.origin = origin;
+    fan.angle = angle;
+    fan.speed = gun.projectileSpeed;
+    fan.seed = static_cast<uint16_t>(rand() & 0xFFFF);
+    fan.pellets = static_cast<uint8_t>(
+        std::min(gun.pellets, static_cast<int>(PelletFan::MAX_PELLETS)));
+    fan.alive = static_cast<uint16_t>((1u << fan.pellets) - 1);
+
+    // clients derive the same directions from the seed
+    for (int pellet = 0; pellet < fan.pellets; ++pellet) {
+        float pelletAngle = angle + pelletSpread(fan.seed, pellet, gun.spread);
+        fan.directions[pellet] = {std::cos(pelletAngle),
+                                  std::sin(pelletAngle)};
+    }
+
+    return entity;
+}
+
 void EntityManager::scheduleForRemoval(entt::entity entity) {
     m_registry.emplace<Removal>(entity);
 }
 
 void EntityManager::removeEntities() {
     m_registry.view<Removal>().each([this](entt::entity entity) {
+        if (auto* networked = m_registry.try_get<Networked>(entity)) {
+            m_netIds.release(networked->netId);
+        }
+        if (auto* fan = m_registry.try_get<PelletFan>(entity)) {
+            m_netIds.release(fan->netId);
+        }
         if (auto* base = m_registry.try_get<Components::EntityBase>(entity)) {
             if (B2_IS_NON_NULL(base->bodyId)) {
                 void* userData = b2Body_GetUserData(base->bodyId);
@@ -0,0 +1,39 @@
+#include "ecs/NetIdAllocator.hpp"
+
+#include <cassert>
+#include <iostream>
+
+NetIdAllocator::NetIdAllocator() {
+    for (uint16_t index = 0; index < CAPACITY; ++index) {
+        m_ids[index] = index;
+        m_free.push_back(index);
+    }
+}
+
+uint16_t NetIdAllocator::allocate() {
+    if (m_free.empty()) {
+        if (!m_exhausted) {
+            std::cout << "Out of net ids, " << CAPACITY
+                      << " networked entities alive" << std::endl;
+            m_exhausted = true;
+        }
+        return NULL_ID;
+    }
+
+    uint16_t index = m_free.front();
+    m_free.pop_front();
+    return m_ids[index];
+}
+
+void NetIdAllocator::release(uint16_t id) {
+    if (id == NULL_ID) return;
+
+    size_t slot = index(id);
+    assert(m_ids[slot] == id);
+    if (m_ids[slot] != id) return;
+
+    // generation lives in the bits above the index and wraps at 16
+    m_ids[slot] = static_cast<uint16_t>(id + (1 << INDEX_BITS));
+    m_free.push_back(static_cast<uint16_t>(slot));
+    m_exhausted = false;
+}
@@ -1,12 +1,16 @@
 #include <box2d/box2d.h>
 #include <uwebsockets/App.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
 
 #include "GameServer.hpp"
 #include "ServerRegistration.hpp"
 #include "SocketServer.hpp"
+#include "network/SocketConfig.hpp"
 
 // Helper function to get environment variable with default value
 std::string getEnvVar(const char* name, const std::string& defaultValue = "") {
@@ -14,6 +18,21 @@ std::string getEnvVar(const char* name, const std::string& defaultValue = "") {
     return value ? std::string(value) : defaultValue;
 }
 
+// Thread counts are parsed signed so "-1" is rejected instead of wrapping to
+// a huge unsigned value, and clamped to the hardware thread count. 0 is left
+// for the caller to interpret.
+unsigned int getThreadCount(const char* name, const std::string& defaultValue) {
+    const std::string value = getEnvVar(name, defaultValue);
+    const long count = std::stol(value);
+    if (count < 0 || count > 1024) {
+        throw std::runtime_error(std::string("Invalid ") + name + ": " + value);
+    }
+
+    const unsigned int hardware =
+        std::max(1u, std::thread::hardware_concurrency());
+    return std::min(static_cast<unsigned int>(count), hardware);
+}
+
 int main() {
     std::cout << "Game has Started!" << std::endl;
 
@@ -25,6 +44,41 @@ int main() {
     int maxPlayers = std::stoi(getEnvVar("MAX_PLAYERS", "100"));
     std::string webApiUrl = getEnvVar("WEB_API_URL", "localhost:3000");
     std::string sharedSecret = getEnvVar("SERVER_SHARED_SECRET", "");
+    std::string compressionMode = getEnvVar("WS_COMPRESSION", "shared");
+
+    SocketConfig socketConfig;
+    socketConfig.threads = getThreadCount("SOCKET_THREADS", "1");
+    // 0 serializes on the hardware threads the socket loops leave free
+    unsigned int serializeThreads = getThreadCount("SERIALIZE_THREADS", "0");
+    if (serializeThreads == 0) {
+        const unsigned int hardware =
+            std::max(1u, std::thread::hardware_concurrency());
+        const unsigned int sockets = std::max(1u, socketConfig.threads);
+        serializeThreads = hardware > sockets ? hardware - sockets : 1;
+    }
+    // parsed signed like the thread counts so "-1" is rejected instead of
+    // wrapping; 64 KiB per client per tick is already far past useful
+    const std::string budgetValue = getEnvVar("SNAPSHOT_BUDGET", "1200");
+    const long snapshotBudget = std::stol(budgetValue);
+    if (snapshotBudget <= 0 || snapshotBudget > 64 * 1024) {
+        throw std::runtime_error("Invalid SNAPSHOT_BUDGET: " + budgetValue);
+    }
+    socketConfig.compression = SocketConfig::parseCompression(compressionMode);
+    socketConfig.compressionThreshold =
+        std::stoul(getEnvVar("WS_COMPRESSION_THRESHOLD", "1024"));
+    socketConfig.sendWatermark =
+        std::stoul(getEnvVar("WS_SEND_WATERMARK", "65536"));
+    socketConfig.sendLimit =
+        std::stoul(getEnvVar("WS_SEND_LIMIT", "1048576"));
+    socketConfig.maxPayloadLength = static_cast<unsigned int>(
+        std::stoul(getEnvVar("WS_MAX_PAYLOAD", "4096")));
+    socketConfig.messageRate = std::stod(getEnvVar("WS_MESSAGE_RATE", "120"));
+    socketConfig.messageBurst =
+        std::stod(getEnvVar("WS_MESSAGE_BURST", "240"));
+    socketConfig.byteRate = std::stod(getEnvVar("WS_BYTE_RATE", "32768"));
+    socketConfig.byteBurst = std::stod(getEnvVar("WS_BYTE_BURST", "65536"));
+    socketConfig.maxMalformedFrames = static_cast<unsigned int>(
+        std::stoul(getEnvVar("WS_MAX_MALFORMED_FRAMES", "10")));
 
     std::cout << "[Config] Server ID: " << serverId << std::endl;
     std::cout << "[Config] Host: " << serverHost << ":" << serverPort
@@ -32,11 +86,27 @@ int main() {
     std::cout << "[Config] Region: " << serverRegion << std::endl;
     std::cout << "[Config] Max Players: " << maxPlayers << std::endl;
     std::cout << "[Config] Web API: " << webApiUrl << std::endl;
+    std::cout << "[Config] Socket Threads: " << socketConfig.threads
+              << std::endl;
+    std::cout << "[Config] Compression: " << compressionMode << " (>= "
+              << socketConfig.compressionThreshold << " bytes)" << std::endl;
+    std::cout << "[Config] Send Watermark/Limit: "
+              << socketConfig.sendWatermark << "/" << socketConfig.sendLimit
+              << " bytes" << std::endl;
+    std::cout << "[Config] Inbound Limits: " << socketConfig.messageRate
+              << " msg/s, " << socketConfig.byteRate << " B/s, max payload "
+              << socketConfig.maxPayloadLength << " bytes" << std::endl;
+    std::cout << "[Config] Snapshot Budget: " << snapshotBudget
+              << " bytes/tick" << std::endl;
+    std::cout << "[Config] Serialize Threads: " << serializeThreads
+              << " (0 = all cores)" << std::endl;
     std::cout << "[Config] Shared Secret: "
               << (sharedSecret.empty() ? "<not set>" : "<set>") << std::endl;
 
     GameServer gameServer;
-    SocketServer socketServer(gameServer, serverPort);
+    gameServer.m_snapshotBudget = static_cast<size_t>(snapshotBudget);
+    gameServer.m_serializeThreads = serializeThreads;
+    SocketServer socketServer(gameServer, serverPort, socketConfig);
 
     // Initialize server registration if web API URL and secret are configured
     std::unique_ptr<ServerRegistration> registration;
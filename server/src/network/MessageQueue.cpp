@@ -0,0 +1,55 @@
+#include "network/MessageQueue.hpp"
+
+#include <cassert>
+
+MessageQueue::MessageQueue(size_t capacity) {
+    // round up to a power of two so positions can be masked into the ring
+    size_t size = ALIGNMENT;
+    while (size < capacity) size <<= 1;
+
+    m_capacity = size;
+    m_mask = size - 1;
+    m_buffer = std::make_unique<char[]>(size);
+}
+
+bool MessageQueue::push(uint32_t clientId, std::string_view payload) {
+    const size_t size = recordSize(payload.length());
+
+    // a record larger than half the ring could wait on a wrap forever
+    if (size > m_capacity / 2) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    size_t offset = head & m_mask;
+    const size_t untilEnd = m_capacity - offset;
+
+    // records never straddle the end of the ring, skip the tail gap instead
+    const size_t needed = untilEnd < size ? untilEnd + size : size;
+
+    if (head + needed - m_cachedTail > m_capacity) {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        if (head + needed - m_cachedTail > m_capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    if (untilEnd < size) {
+        // untilEnd is a multiple of ALIGNMENT, so a header always fits here
+        assert(untilEnd >= sizeof(RecordHeader));
+        RecordHeader marker{0, WRAP_MARKER};
+        std::memcpy(m_buffer.get() + offset, &marker, sizeof(marker));
+        head += untilEnd;
+        offset = 0;
+    }
+
+    RecordHeader header{clientId, static_cast<uint32_t>(payload.length())};
+    std::memcpy(m_buffer.get() + offset, &header, sizeof(header));
+    std::memcpy(m_buffer.get() + offset + sizeof(header), payload.data(),
+                payload.length());
+
+    m_head.store(head + size, std::memory_order_release);
+    return true;
+}
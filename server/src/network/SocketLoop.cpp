@@ -0,0 +1,147 @@
+#include "network/SocketLoop.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include "client/Client.hpp"
+#include "common/enums.hpp"
+
+void SocketLoop::setLoop(uWS::Loop* loop) {
+    m_loop.store(loop, std::memory_order_release);
+}
+
+bool SocketLoop::isReady() const {
+    return m_loop.load(std::memory_order_acquire) != nullptr;
+}
+
+SocketLoop::ReceiveResult SocketLoop::receive(WebSocketData& data,
+                                              std::string_view message) {
+    InputSlot& input = data.input;
+
+    m_reader.loadMessage(message);
+    m_forward.clear();
+
+    bool malformed = false;
+    while (!malformed && m_reader.getOffset() < m_reader.byteLength()) {
+        const size_t start = m_reader.getOffset();
+        const uint8_t header = m_reader.readU8();
+
+        switch (header) {
+            case ClientHeader::MOUSE: {
+                const float angle = m_reader.readFloat();
+                if (m_reader.failed()) break;
+                input.angle.store(angle, std::memory_order_relaxed);
+                break;
+            }
+            case ClientHeader::MOVEMENT: {
+                const uint8_t direction = m_reader.readU8();
+                if (m_reader.failed()) break;
+                input.direction.store(direction, std::memory_order_relaxed);
+                break;
+            }
+            case ClientHeader::MOUSE_DOWN:
+                input.mouseDown.store(true, std::memory_order_relaxed);
+                input.edges.fetch_or(InputSlot::CLICK,
+                                     std::memory_order_relaxed);
+                break;
+            case ClientHeader::MOUSE_UP:
+                input.mouseDown.store(false, std::memory_order_relaxed);
+                break;
+            case ClientHeader::RELOAD:
+                input.edges.fetch_or(InputSlot::RELOAD,
+                                     std::memory_order_relaxed);
+                break;
+            case ClientHeader::PICKUP_REQUEST:
+                input.edges.fetch_or(InputSlot::PICKUP,
+                                     std::memory_order_relaxed);
+                break;
+            case ClientHeader::SWITCH_ITEM: {
+                const uint8_t slot = m_reader.readU8();
+                if (m_reader.failed()) break;
+                input.switchSlot.store(static_cast<int8_t>(slot),
+                                       std::memory_order_relaxed);
+                break;
+            }
+            case ClientHeader::SNAPSHOT_ACK: {
+                const uint32_t tick = m_reader.readU32();
+                if (m_reader.failed()) break;
+                // acks can arrive out of order, keep the newest
+                uint32_t acked =
+                    input.snapshotAck.load(std::memory_order_relaxed);
+                if (tick > acked) {
+                    input.snapshotAck.store(tick, std::memory_order_relaxed);
+                }
+                break;
+            }
+            case ClientHeader::SPAWN:
+            case ClientHeader::CLIENT_CHAT:
+                m_reader.readString();
+                if (m_reader.failed()) break;
+                m_forward.append(
+                    message.substr(start, m_reader.getOffset() - start));
+                break;
+            default:
+                // the rest of the frame cannot be framed without knowing
+                // this message's length
+                malformed = true;
+                break;
+        }
+
+        malformed = malformed || m_reader.failed();
+    }
+
+    if (malformed) {
+        ++data.malformedFrames;
+        m_malformedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!m_forward.empty() && !m_messages.push(data.id, m_forward)) {
+        return ReceiveResult::QUEUE_FULL;
+    }
+    return malformed ? ReceiveResult::MALFORMED : ReceiveResult::OK;
+}
+
+void SocketLoop::addConnection(Client* client) {
+    m_connections.push_back(client);
+}
+
+void SocketLoop::removeConnection(Client* client) {
+    auto it = std::find(m_connections.begin(), m_connections.end(), client);
+    if (it != m_connections.end()) {
+        *it = m_connections.back();
+        m_connections.pop_back();
+    }
+}
+
+void SocketLoop::deferFlush() {
+    uWS::Loop* loop = m_loop.load(std::memory_order_acquire);
+    if (!loop) return;
+
+    loop->defer([this]() { flush(); });
+}
+
+void SocketLoop::flush() {
+    for (Client* client : m_connections) {
+        switch (client->sendBytes(m_config)) {
+            case Client::SendResult::SNAPSHOT_SKIPPED:
+                m_skippedSnapshots.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case Client::SendResult::OVER_LIMIT:
+                m_overLimit.push_back(client);
+                break;
+            case Client::SendResult::SENT:
+                break;
+        }
+    }
+
+    // ending a socket runs the close handler, which removes the client from
+    // m_connections, so it has to wait until the loop above is done
+    for (Client* client : m_overLimit) {
+        std::cout << "Client " << client->m_id
+                  << " exceeded the send buffer limit, disconnecting"
+                  << std::endl;
+        m_slowDisconnects.fetch_add(1, std::memory_order_relaxed);
+        client->m_ws->end(1008, "Send buffer limit exceeded");
+    }
+    m_overLimit.clear();
+}
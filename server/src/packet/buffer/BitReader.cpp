@@ -0,0 +1,61 @@
+#include "packet/buffer/BitReader.hpp"
+
+#include <algorithm>
+
+void BitReader::loadMessage(const std::string_view& message) {
+    m_message = message;
+    m_bitOffset = 0;
+    m_failed = false;
+}
+
+bool BitReader::validateBounds(unsigned int bits) {
+    if (m_failed || m_bitOffset + bits > m_message.length() * 8) {
+        m_failed = true;
+        return false;
+    }
+    return true;
+}
+
+uint32_t BitReader::readBits(unsigned int bits) {
+    if (!validateBounds(bits)) return 0;
+
+    uint32_t value = 0;
+    unsigned int read = 0;
+    while (read < bits) {
+        const unsigned int shift = m_bitOffset & 7;
+        const unsigned int take = std::min(8 - shift, bits - read);
+        const uint32_t byte =
+            static_cast<uint8_t>(m_message[m_bitOffset >> 3]) >> shift;
+
+        value |= (byte & ((1u << take) - 1)) << read;
+        read += take;
+        m_bitOffset += take;
+    }
+    return value;
+}
+
+bool BitReader::readBool() { return readBits(1) != 0; }
+
+uint32_t BitReader::readVarU32() {
+    uint32_t value = 0;
+    for (unsigned int shift = 0; shift < 35; shift += 7) {
+        uint32_t group = readBits(8);
+        value |= (group & 0x7F) << shift;
+        if ((group & 0x80) == 0) return value;
+    }
+    // more than five groups cannot come from BitWriter
+    m_failed = true;
+    return 0;
+}
+
+int32_t BitReader::readVarS32() {
+    uint32_t zigzag = readVarU32();
+    return static_cast<int32_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+}
+
+void BitReader::alignToByte() {
+    m_bitOffset = (m_bitOffset + 7) & ~static_cast<size_t>(7);
+}
+
+size_t BitReader::getOffset() { return (m_bitOffset + 7) >> 3; }
+size_t BitReader::byteLength() { return m_message.length(); }
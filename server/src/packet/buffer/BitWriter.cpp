@@ -0,0 +1,52 @@
+#include "packet/buffer/BitWriter.hpp"
+
+#include <cassert>
+
+void BitWriter::writeBits(uint32_t value, unsigned int bits) {
+    assert(bits <= 32);
+    if (bits < 32) value &= (1u << bits) - 1;
+
+    m_scratch |= static_cast<uint64_t>(value) << m_scratchBits;
+    m_scratchBits += bits;
+
+    while (m_scratchBits >= 8) {
+        m_message.push_back(static_cast<char>(m_scratch & 0xFF));
+        m_scratch >>= 8;
+        m_scratchBits -= 8;
+    }
+}
+
+void BitWriter::writeBool(bool value) { writeBits(value ? 1 : 0, 1); }
+
+void BitWriter::writeVarU32(uint32_t value) {
+    while (value >= 0x80) {
+        writeBits((value & 0x7F) | 0x80, 8);
+        value >>= 7;
+    }
+    writeBits(value, 8);
+}
+
+void BitWriter::writeVarS32(int32_t value) {
+    uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^
+                      static_cast<uint32_t>(value >> 31);
+    writeVarU32(zigzag);
+}
+
+void BitWriter::alignToByte() {
+    if (m_scratchBits > 0) writeBits(0, 8 - m_scratchBits);
+}
+
+std::string_view BitWriter::getMessage() {
+    alignToByte();
+    return m_message;
+}
+
+void BitWriter::clear() {
+    m_message.clear();
+    m_scratch = 0;
+    m_scratchBits = 0;
+}
+
+bool BitWriter::hasData() { return !m_message.empty() || m_scratchBits > 0; }
+
+size_t BitWriter::bitLength() { return m_message.size() * 8 + m_scratchBits; }
@@ -2,22 +2,19 @@
 
 #include <cstdint>
 #include <cstring>
-#include <iostream>
-#include <sstream>
 
 void PacketReader::loadMessage(const std::string_view& message) {
     m_message = message;
     m_offset = 0;
+    m_failed = false;
 }
 
-void PacketReader::validateBounds(unsigned int length) {
-    if (m_offset + length > m_message.length()) {
-        std::ostringstream oss;
-        oss << "PacketReader Error - overflow: "
-            << "offset=" << m_offset << ", length=" << length
-            << ", message_length=" << m_message.length();
-        throw std::runtime_error(oss.str());
+bool PacketReader::validateBounds(size_t length) {
+    if (m_failed || m_offset + length > m_message.length()) {
+        m_failed = true;
+        return false;
     }
+    return true;
 }
 
 uint8_t PacketReader::readU8() { return readBytes<uint8_t>(); }
@@ -28,14 +25,12 @@ uint32_t PacketReader::readU32() { return readBytes<uint32_t>(); }
 
 uint64_t PacketReader::readU64() { return readBytes<uint64_t>(); }
 
-float PacketReader::readFloat() {
-    uint32_t value = readBytes<uint32_t>();
-    return *reinterpret_cast<float*>(&value);
-}
+float PacketReader::readFloat() { return readBytes<float>(); }
 
 std::string PacketReader::readString() {
     uint16_t length = readU16();
-    validateBounds(length);
+    if (!validateBounds(length)) return std::string();
+
     std::string value = std::string(m_message.substr(m_offset, length));
     m_offset += length;
     return value;
@@ -43,7 +38,7 @@ std::string PacketReader::readString() {
 
 template <class T>
 T PacketReader::readBytes() {
-    validateBounds(sizeof(T));
+    if (!validateBounds(sizeof(T))) return T{};
 
     T value;
     std::memcpy(&value, m_message.data() + m_offset, sizeof(T));
@@ -1,7 +1,10 @@
 #include "packet/buffer/PacketWriter.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <string_view>
+#include <utility>
 
 void PacketWriter::writeU8(uint8_t x) { writeBytes<uint8_t>(x); }
 
@@ -11,31 +14,60 @@ void PacketWriter::writeU32(uint32_t x) { writeBytes<uint32_t>(x); }
 
 void PacketWriter::writeU64(uint64_t x) { writeBytes<uint64_t>(x); }
 
-void PacketWriter::writeFloat(float x) {
-    writeBytes<uint32_t>(*reinterpret_cast<uint32_t*>(&x));
-}
+void PacketWriter::writeFloat(float x) { writeBytes<float>(x); }
 
 void PacketWriter::writeString(const std::string& x) {
     auto len = static_cast<uint16_t>(x.length());
-    writeU16(len);
-    for (const unsigned char& c : x) {
-        writeU8(c);
-    }
+    char* out = claim(sizeof(len) + len);
+    std::memcpy(out, &len, sizeof(len));
+    std::memcpy(out + sizeof(len), x.data(), len);
 }
 
 template <class T>
 void PacketWriter::writeBytes(T data) {
-    const char* bytes = reinterpret_cast<const char*>(&data);
-    for (size_t i = 0; i < sizeof(T); i++) {
-        m_message.push_back(bytes[i]);
+    std::memcpy(claim(sizeof(T)), &data, sizeof(T));
+}
+
+void PacketWriter::appendRaw(std::string_view bytes) {
+    if (bytes.empty()) return;
+    std::memcpy(claim(bytes.length()), bytes.data(), bytes.length());
+}
+
+char* PacketWriter::claim(size_t bytes) {
+    const size_t end = m_offset + bytes;
+    if (end > m_message.size()) {
+        m_message.resize(std::max(end, m_message.size() * 2));
+    }
+
+    char* out = &m_message[m_offset];
+    m_offset = end;
+    return out;
+}
+
+void PacketWriter::reserve(size_t bytes) {
+    if (m_offset + bytes > m_message.size()) {
+        m_message.resize(m_offset + bytes);
     }
 }
 
-std::string_view PacketWriter::getMessage() { return m_message; }
+std::string_view PacketWriter::getMessage() {
+    return std::string_view(m_message.data(), m_offset);
+}
+
+void PacketWriter::clear() { m_offset = 0; }
 
-void PacketWriter::clear() {
+bool PacketWriter::hasData() { return m_offset > 0; }
+
+void PacketWriter::swap(PacketWriter& other) {
+    m_message.swap(other.m_message);
+    std::swap(m_offset, other.m_offset);
+}
+
+SharedBuffer PacketWriter::share() {
+    m_message.resize(m_offset);
+    SharedBuffer buffer =
+        std::make_shared<const std::string>(std::move(m_message));
     m_message.clear();
     m_offset = 0;
+    return buffer;
 }
-
-bool PacketWriter::hasData() { return m_message.length() > 0; }
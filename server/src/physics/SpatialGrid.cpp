@@ -0,0 +1,48 @@
+#include "physics/SpatialGrid.hpp"
+
+SpatialGrid::SpatialGrid(float cellSize) : m_grid(cellSize) {}
+
+void SpatialGrid::update(entt::entity entity, b2Vec2 position) {
+    const size_t index = entt::to_entity(entity);
+    if (index >= m_locations.size()) m_locations.resize(index + 1);
+
+    const uint64_t cell = m_grid.keyAt(position);
+    Location& location = m_locations[index];
+    if (location.placed) {
+        if (location.cell == cell) return;
+        remove(entity);
+    }
+
+    std::vector<entt::entity>& bucket = m_cells[cell];
+    location = {cell, static_cast<uint32_t>(bucket.size()), true};
+    bucket.push_back(entity);
+}
+
+void SpatialGrid::remove(entt::entity entity) {
+    const size_t index = entt::to_entity(entity);
+    if (index >= m_locations.size() || !m_locations[index].placed) return;
+
+    Location& location = m_locations[index];
+    std::vector<entt::entity>& bucket = m_cells[location.cell];
+
+    // swap the last entry into the hole
+    entt::entity last = bucket.back();
+    bucket[location.slot] = last;
+    m_locations[entt::to_entity(last)].slot = location.slot;
+    bucket.pop_back();
+
+    location.placed = false;
+}
+
+void CellBuckets::clear() {
+    for (uint64_t key : m_used) m_buckets[key].clear();
+    m_used.clear();
+}
+
+void CellBuckets::insert(uint32_t item, const b2AABB& bounds) {
+    m_grid.forEachCell(bounds, [&](uint64_t key) {
+        std::vector<uint32_t>& bucket = m_buckets[key];
+        if (bucket.empty()) m_used.push_back(key);
+        bucket.push_back(item);
+    });
+}
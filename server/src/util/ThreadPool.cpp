@@ -0,0 +1,83 @@
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(threads - 1);
+    for (size_t worker = 1; worker < threads; ++worker) {
+        m_workers.emplace_back([this, worker] { workerLoop(worker); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& thread : m_workers) thread.join();
+}
+
+void ThreadPool::parallelFor(size_t count, const Job& job) {
+    if (count == 0) return;
+
+    // not worth waking anyone
+    if (m_workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) job(i, 0);
+        return;
+    }
+
+    // the caller takes a share, so only wake as many workers as there are
+    // indices left over
+    const size_t helpers = std::min(count - 1, m_workers.size());
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_count = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_claims = helpers;
+        m_busy = helpers;
+    }
+    if (helpers == m_workers.size()) {
+        m_wake.notify_all();
+    } else {
+        for (size_t i = 0; i < helpers; ++i) m_wake.notify_one();
+    }
+
+    runJobs(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy == 0; });
+    m_job = nullptr;
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || m_claims > 0; });
+            if (m_stopping) return;
+            --m_claims;
+        }
+
+        runJobs(worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy == 0) m_done.notify_one();
+    }
+}
+
+void ThreadPool::runJobs(size_t worker) {
+    // indices are handed out one at a time, so a slow client does not hold
+    // up a whole chunk
+    size_t index;
+    while ((index = m_next.fetch_add(1, std::memory_order_relaxed)) <
+           m_count) {
+        (*m_job)(index, worker);
+    }
+}